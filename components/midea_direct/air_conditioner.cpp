@@ -1,6 +1,6 @@
 #include "air_conditioner.h"
 #include "timer.h"
-#include "esphome/core/log.h"
+#include "port.h"
 
 namespace esphome {
 namespace midea {
@@ -11,14 +11,32 @@ static const char *TAG = "AirConditioner";
 void AirConditioner::setup_() {
   if (this->autoconf_status_ != AUTOCONF_DISABLED)
     this->getCapabilities_();
+  this->statusCadence_.setRange(this->getPeriod(), STATUS_MAX_INTERVAL_MS);
+  this->timer_manager_.registerTimer(this->statusTimer_);
+  this->statusTimer_.setCallback([this](Timer *timer) { this->statusDue_ = true; });
   this->timer_manager_.registerTimer(this->powerUsageTimer_);
-  this->powerUsageTimer_.setCallback([this](Timer *timer) {
-    timer->reset();
-    this->getPowerUsage_();
-  });
+  this->powerUsageTimer_.setCallback([this](Timer *timer) { this->pollPowerUsage_(); });
   this->powerUsageTimer_.start(POWER_USAGE_QUERY_INTERVAL_MS);
 }
 
+void AirConditioner::onIdle_() {
+  if (!this->statusDue_)
+    return;
+  this->statusDue_ = false;
+  // Rearmed by the response; this keeps polling if it never comes
+  this->statusTimer_.start(this->statusCadence_.interval());
+  this->getStatus_();
+}
+
+void AirConditioner::pollPowerUsage_() {
+  if (this->autoconf_status_ == AUTOCONF_OK && !this->capabilities_.powerCal()) {
+    ESP_LOGD(TAG, "No power meter reported, power usage polling stopped");
+    return;
+  }
+  this->powerUsageTimer_.start(this->powerCadence_.interval());
+  this->getPowerUsage_();
+}
+
 static bool checkConstraints(const Mode &mode, const Preset &preset) {
   if (mode == Mode::MODE_OFF)
     return preset == Preset::PRESET_NONE;
@@ -39,16 +57,32 @@ static bool checkConstraints(const Mode &mode, const Preset &preset) {
 }
 
 void AirConditioner::control(const Control &control) {
-  if (this->sendControl_)
-    return;
-
-  // Command coalescing: avoid sending duplicate commands too quickly
-  uint32_t now = esphome::millis();
-  if (now - this->lastCommandTime_ < 50) { // 50ms debounce for better responsiveness
-    ESP_LOGD(TAG, "Command debounced - too soon after last command");
+  if (this->hasPendingControl_)
+    ++this->mergedControls_;
+  this->pendingControl_.merge(control);
+  this->hasPendingControl_ = true;
+  if (this->controlInFlight_) {
+    ESP_LOGD(TAG, "Command in flight, merging the control into the pending one");
     return;
   }
+  this->flushControl_();
+}
+
+void AirConditioner::loop_() {
+  // Deliver controls merged while the previous command was in flight. Not done from the
+  // request handlers: those run before the engine has released the completed request.
+  if (this->hasPendingControl_ && !this->controlInFlight_)
+    this->flushControl_();
+}
+
+void AirConditioner::flushControl_() {
+  const Control pending = this->pendingControl_;
+  this->pendingControl_ = Control{};
+  this->hasPendingControl_ = false;
+  this->sendControl_(pending);
+}
 
+void AirConditioner::sendControl_(const Control &control) {
   StatusData status = this->status_;
   Mode mode = this->mode_;
   Preset preset = this->preset_;
@@ -87,61 +121,47 @@ void AirConditioner::control(const Control &control) {
     status.setTargetTemp(control.targetTemp.value());
   }
   if (hasUpdate) {
-    this->sendControl_ = true;
+    this->controlInFlight_ = true;
     status.setMode(mode);
     status.setPreset(preset);
     status.setBeeper(this->beeper_);
-    status.appendCRC();
-
-    // Check if this command is identical to the last one sent recently
-    if (this->lastSentCommand_.size() > 0 &&
-        status.getMode() == this->lastSentCommand_.getMode() &&
-        status.getFanMode() == this->lastSentCommand_.getFanMode() &&
-        status.getSwingMode() == this->lastSentCommand_.getSwingMode() &&
-        status.getPreset() == this->lastSentCommand_.getPreset() &&
-        std::abs(status.getTargetTemp() - this->lastSentCommand_.getTargetTemp()) < 0.1f &&
-        now - this->lastCommandTime_ < 2000) { // 2 seconds
-      ESP_LOGD(TAG, "Skipping duplicate command - identical to last sent command");
-      this->sendControl_ = false;
-      return;
-    }
-
-    // Update last command tracking
-    this->lastSentCommand_ = status;
-    this->lastCommandTime_ = now;
+    status.seal();
 
     if (isModeChanged && preset != Preset::PRESET_NONE && preset != Preset::PRESET_SLEEP) {
-      // Last command with preset
-      this->setStatus_(status);
-      status.setPreset(Preset::PRESET_NONE);
-      status.setBeeper(false);
-      status.updateCRC();
       // First command without preset
-      this->queueRequestPriority_(FrameType::DEVICE_CONTROL, std::move(status),
+      StatusData modeOnly = status;
+      modeOnly.setPreset(Preset::PRESET_NONE);
+      modeOnly.setBeeper(false);
+      modeOnly.seal();
+      this->sendUserCommand(FrameType::DEVICE_CONTROL, std::move(modeOnly),
         // onData
-        std::bind(&AirConditioner::readStatus_, this, std::placeholders::_1)
+        [this](FrameView data) { return this->readStatus_(data); }
       );
+      // Last command with preset
+      this->setStatus_(std::move(status), true);
     } else {
       this->setStatus_(std::move(status));
     }
   }
 }
 
-void AirConditioner::setStatus_(StatusData status) {
+void AirConditioner::setStatus_(StatusData status, bool queued) {
   ESP_LOGD(TAG, "Sending user command SET_STATUS(0x40) request with high priority...");
-  this->sendUserCommand(FrameType::DEVICE_CONTROL, std::move(status),
-    // onData
-    std::bind(&AirConditioner::readStatus_, this, std::placeholders::_1),
-    // onSuccess
-    [this]() {
-      this->sendControl_ = false;
-    },
-    // onError
-    [this]() {
-      ESP_LOGW(TAG, "SET_STATUS(0x40) request failed...");
-      this->sendControl_ = false;
-    }
-  );
+  // Follow the unit closely while it settles into the new state
+  this->statusCadence_.reset();
+  this->powerCadence_.reset();
+  if (this->powerUsageTimer_.isEnabled())
+    this->powerUsageTimer_.start(this->powerCadence_.interval());
+  ResponseHandler onData = [this](FrameView data) { return this->readStatus_(data); };
+  Handler onSuccess = [this]() { this->controlInFlight_ = false; };
+  Handler onError = [this]() {
+    ESP_LOGW(TAG, "SET_STATUS(0x40) request failed...");
+    this->controlInFlight_ = false;
+  };
+  if (queued)
+    this->queueRequestPriority_(FrameType::DEVICE_CONTROL, std::move(status), onData, onSuccess, onError);
+  else
+    this->sendUserCommand(FrameType::DEVICE_CONTROL, std::move(status), onData, onSuccess, onError);
 }
 
 void AirConditioner::setPowerState(bool state) {
@@ -155,19 +175,23 @@ void AirConditioner::setPowerState(bool state) {
 void AirConditioner::getPowerUsage_() {
   QueryPowerData data{};
   ESP_LOGD(TAG, "Enqueuing a GET_POWERUSAGE(0x41) request...");
-  this->queueRequest_(FrameType::DEVICE_QUERY, std::move(data),
+  this->queueQuery_(FrameType::DEVICE_QUERY, std::move(data),
     // onData
-    [this](FrameData data) -> ResponseStatus {
-      const auto status = data.to<StatusData>();
+    [this](FrameView data) -> ResponseStatus {
+      const StatusView status(data);
       if (!status.hasPowerInfo())
         return ResponseStatus::RESPONSE_WRONG;
       if (this->powerUsage_ != status.getPowerUsage()) {
         this->powerUsage_ = status.getPowerUsage();
+        this->powerCadence_.reset();
         this->sendUpdate();
+      } else {
+        this->powerCadence_.backoff();
       }
+      if (this->powerUsageTimer_.isEnabled())
+        this->powerUsageTimer_.start(this->powerCadence_.interval());
       return ResponseStatus::RESPONSE_OK;
-    },
-    nullptr, nullptr, PRIORITY_BACKGROUND
+    }
   );
 }
 
@@ -175,9 +199,9 @@ void AirConditioner::getCapabilities_() {
   GetCapabilitiesData data{};
   this->autoconf_status_ = AUTOCONF_PROGRESS;
   ESP_LOGD(TAG, "Enqueuing a priority GET_CAPABILITIES(0xB5) request...");
-  this->queueRequest_(FrameType::DEVICE_QUERY, std::move(data),
+  this->queueQuery_(FrameType::DEVICE_QUERY, std::move(data),
     // onData
-    [this](FrameData data) -> ResponseStatus {
+    [this](FrameView data) -> ResponseStatus {
       if (!data.hasID(0xB5))
         return ResponseStatus::RESPONSE_WRONG;
       if (this->capabilities_.read(data)) {
@@ -195,18 +219,16 @@ void AirConditioner::getCapabilities_() {
     [this]() {
       ESP_LOGW(TAG, "Failed to get 0xB5 capabilities report.");
       this->autoconf_status_ = AUTOCONF_ERROR;
-    },
-    PRIORITY_BACKGROUND
+    }
   );
 }
 
 void AirConditioner::getStatus_() {
   QueryStateData data{};
   ESP_LOGD(TAG, "Enqueuing a GET_STATUS(0x41) request...");
-  this->queueRequest_(FrameType::DEVICE_QUERY, std::move(data),
+  this->queueQuery_(FrameType::DEVICE_QUERY, std::move(data),
     // onData
-    std::bind(&AirConditioner::readStatus_, this, std::placeholders::_1),
-    nullptr, nullptr, PRIORITY_BACKGROUND
+    [this](FrameView data) { return this->readStatus_(data); }
   );
 }
 
@@ -215,7 +237,7 @@ void AirConditioner::displayToggle_() {
   ESP_LOGD(TAG, "Enqueuing a priority TOGGLE_LIGHT(0x41) request...");
   this->queueRequest_(FrameType::DEVICE_QUERY, std::move(data),
     // onData
-    std::bind(&AirConditioner::readStatus_, this, std::placeholders::_1)
+    [this](FrameView data) { return this->readStatus_(data); }
   );
 }
 
@@ -227,14 +249,15 @@ void setProperty(T &property, const T &value, bool &update) {
   }
 }
 
-ResponseStatus AirConditioner::readStatus_(FrameData data) {
+ResponseStatus AirConditioner::readStatus_(FrameView data) {
   if (!data.hasStatus())
     return ResponseStatus::RESPONSE_WRONG;
   ESP_LOGD(TAG, "New status data received. Parsing...");
   bool hasUpdate = false;
-  const StatusData newStatus = data.to<StatusData>();
+  const StatusView newStatus(data);
   this->status_.copyStatus(newStatus);
-  if (this->mode_ != newStatus.getMode()) {
+  const bool modeChanged = this->mode_ != newStatus.getMode();
+  if (modeChanged) {
     hasUpdate = true;
     this->mode_ = newStatus.getMode();
     if (newStatus.getMode() == Mode::MODE_OFF)
@@ -247,6 +270,15 @@ ResponseStatus AirConditioner::readStatus_(FrameData data) {
   setProperty(this->indoorTemp_, newStatus.getIndoorTemp(), hasUpdate);
   setProperty(this->outdoorTemp_, newStatus.getOutdoorTemp(), hasUpdate);
   setProperty(this->indoorHumidity_, newStatus.getHumiditySetpoint(), hasUpdate);
+  // Poll fast while the state moves; back off while it is stable or the unit is off
+  // (a unit that is off only counts switching on)
+  if (modeChanged || (hasUpdate && this->mode_ != Mode::MODE_OFF))
+    this->statusCadence_.reset();
+  else
+    this->statusCadence_.backoff();
+  // Any fresh status, including control echoes, restarts the wait for the next poll
+  this->statusDue_ = false;
+  this->statusTimer_.start(this->statusCadence_.interval());
   if (hasUpdate)
     this->sendUpdate();
   return ResponseStatus::RESPONSE_OK;
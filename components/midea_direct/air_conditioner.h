@@ -1,5 +1,6 @@
 #pragma once
 #include "appliance_base.h"
+#include "cadence.h"
 #include "capabilities.h"
 #include "status_data.h"
 
@@ -9,6 +10,9 @@ namespace ac {
 
 // Constants
 static constexpr uint32_t POWER_USAGE_QUERY_INTERVAL_MS = 10000;
+// Longest polling intervals while readings are stable or the unit is off
+static constexpr uint32_t POWER_USAGE_MAX_INTERVAL_MS = 160000;
+static constexpr uint32_t STATUS_MAX_INTERVAL_MS = 60000;
 
 // Air conditioner control command
 struct Control {
@@ -17,14 +21,32 @@ struct Control {
   Optional<Preset> preset{};
   Optional<FanMode> fanMode{};
   Optional<SwingMode> swingMode{};
+  /// Take every field set in `other`, keeping the rest
+  void merge(const Control &other) {
+    if (other.targetTemp.has_value())
+      this->targetTemp = other.targetTemp;
+    if (other.mode.has_value())
+      this->mode = other.mode;
+    if (other.preset.has_value())
+      this->preset = other.preset;
+    if (other.fanMode.has_value())
+      this->fanMode = other.fanMode;
+    if (other.swingMode.has_value())
+      this->swingMode = other.swingMode;
+  }
 };
 
 class AirConditioner : public ApplianceBase {
  public:
   AirConditioner() : ApplianceBase(AIR_CONDITIONER) {}
   void setup_() override;
-  void onIdle_() override { this->getStatus_(); }
+  void onIdle_() override;
+  void loop_() override;
+  /// Request a state change. While a command is in flight, calls are merged field by field and
+  /// sent as one frame once it completes, so the last value of every field always wins.
   void control(const Control &control);
+  /// Controls merged into a pending one instead of being sent on their own
+  uint32_t getMergedControls() const { return this->mergedControls_; }
   void setPowerState(bool state);
   bool getPowerState() const { return this->mode_ != Mode::MODE_OFF; }
   void togglePowerState() { this->setPowerState(this->mode_ == Mode::MODE_OFF); }
@@ -38,16 +60,28 @@ class AirConditioner : public ApplianceBase {
   FanMode getFanMode() const { return this->fanMode_; }
   Preset getPreset() const { return this->preset_; }
   const Capabilities &getCapabilities() const { return this->capabilities_; }
+  /// Current status and power polling intervals
+  uint32_t getStatusInterval() const { return this->statusCadence_.interval(); }
+  uint32_t getPowerUsageInterval() const { return this->powerCadence_.interval(); }
   void displayToggle() { this->displayToggle_(); }
  protected:
   void getPowerUsage_();
+  void pollPowerUsage_();
   void getCapabilities_();
   void getStatus_();
-  void setStatus_(StatusData status);
+  void flushControl_();
+  void sendControl_(const Control &control);
+  void setStatus_(StatusData status, bool queued = false);
   void displayToggle_();
-  ResponseStatus readStatus_(FrameData data);
+  ResponseStatus readStatus_(FrameView data);
   Capabilities capabilities_{};
   Timer powerUsageTimer_;
+  // Next status poll due
+  Timer statusTimer_;
+  // Polling intervals: fast after commands and changes, backing off while stable
+  PollCadence statusCadence_{1000, STATUS_MAX_INTERVAL_MS};
+  PollCadence powerCadence_{POWER_USAGE_QUERY_INTERVAL_MS, POWER_USAGE_MAX_INTERVAL_MS};
+  bool statusDue_{true};
   float indoorHumidity_{};
   float indoorTemp_{};
   float outdoorTemp_{};
@@ -59,10 +93,12 @@ class AirConditioner : public ApplianceBase {
   SwingMode swingMode_{SwingMode::SWING_OFF};
   Preset lastPreset_{Preset::PRESET_NONE};
   StatusData status_{};
-  bool sendControl_{};
-  // Command coalescing
-  StatusData lastSentCommand_{};
-  uint32_t lastCommandTime_{0};
+  // A control command is in flight
+  bool controlInFlight_{};
+  // Latest-wins mailbox for controls received meanwhile
+  Control pendingControl_{};
+  bool hasPendingControl_{};
+  uint32_t mergedControls_{};
 };
 
 }  // namespace ac
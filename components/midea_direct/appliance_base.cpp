@@ -1,17 +1,108 @@
+#ifndef MIDEA_HOST
 #include "esphome/components/wifi/wifi_component.h"
 #include "esphome/components/network/util.h"
 #include "esphome/core/util.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/defines.h"
 #include "esphome/core/component.h"
+#endif
 #include "appliance_base.h"
-#include "esphome/core/log.h"
+#include "port.h"
+#include <algorithm>
+#include <cstring>
 
 namespace esphome {
 namespace midea {
 
 static const char *TAG = "ApplianceBase";
 
+uint32_t ApplianceBase::RequestScheduler::age(RequestPriority priority, uint32_t now) const {
+  const Request *head = this->queues_[priority].head;
+  return head != nullptr ? now - head->queuedAt : 0;
+}
+
+void ApplianceBase::RequestScheduler::push(Request *request, uint32_t now) {
+  Fifo &fifo = this->queues_[request->priority];
+  request->next = nullptr;
+  request->queuedAt = now;
+  if (fifo.tail != nullptr)
+    fifo.tail->next = request;
+  else
+    fifo.head = request;
+  fifo.tail = request;
+  ++fifo.size;
+  ++this->size_;
+}
+
+void ApplianceBase::RequestScheduler::pushFront(Request *request, uint32_t now) {
+  Fifo &fifo = this->queues_[request->priority];
+  request->next = fifo.head;
+  request->queuedAt = now;
+  fifo.head = request;
+  if (fifo.tail == nullptr)
+    fifo.tail = request;
+  ++fifo.size;
+  ++this->size_;
+}
+
+ApplianceBase::Request *ApplianceBase::RequestScheduler::pop(uint32_t now, uint32_t agingLimit) {
+  static constexpr RequestPriority ORDER[] = {PRIORITY_USER_COMMAND, PRIORITY_USER_SEQUENCE, PRIORITY_BACKGROUND};
+  const Request *oldest = nullptr;
+  RequestPriority next = PRIORITY_BACKGROUND;
+  for (RequestPriority priority : ORDER) {
+    const Request *head = this->queues_[priority].head;
+    if (head == nullptr)
+      continue;
+    if (oldest == nullptr) {
+      // Highest non-empty class, unless an older request has aged out
+      oldest = head;
+      next = priority;
+    } else if (now - head->queuedAt >= agingLimit && static_cast<int32_t>(head->queuedAt - oldest->queuedAt) < 0) {
+      oldest = head;
+      next = priority;
+    }
+  }
+  return oldest != nullptr ? this->pop(next) : nullptr;
+}
+
+ApplianceBase::Request *ApplianceBase::RequestScheduler::find(uint32_t key) const {
+  for (const Fifo &fifo : this->queues_)
+    for (Request *it = fifo.head; it != nullptr; it = it->next)
+      if (it->key == key)
+        return it;
+  return nullptr;
+}
+
+ApplianceBase::Request *ApplianceBase::RequestScheduler::popBack(RequestPriority priority) {
+  Fifo &fifo = this->queues_[priority];
+  // The head stays: it may be a preempted request
+  if (fifo.size <= 1)
+    return nullptr;
+  Request *request = fifo.tail;
+  Request *prev = fifo.head;
+  while (prev->next != request)
+    prev = prev->next;
+  prev->next = nullptr;
+  fifo.tail = prev;
+  --fifo.size;
+  --this->size_;
+  return request;
+}
+
+ApplianceBase::Request *ApplianceBase::RequestScheduler::pop(RequestPriority priority) {
+  Fifo &fifo = this->queues_[priority];
+  Request *request = fifo.head;
+  if (request == nullptr)
+    return nullptr;
+  fifo.head = request->next;
+  if (fifo.head == nullptr)
+    fifo.tail = nullptr;
+  request->next = nullptr;
+  --fifo.size;
+  --this->size_;
+  return request;
+}
+
 ResponseStatus ApplianceBase::Request::callHandler(const Frame &frame) {
   if (!frame.hasType(this->requestType))
     return ResponseStatus::RESPONSE_WRONG;
@@ -20,68 +111,189 @@ ResponseStatus ApplianceBase::Request::callHandler(const Frame &frame) {
   return this->onData(frame.getData());
 }
 
-bool ApplianceBase::FrameReceiver::read(uart::UARTDevice *uart_device) {
-  while (uart_device->available()) {
-    uint8_t data;
-    if (!uart_device->read_byte(&data)) {
-      break;
+bool ApplianceBase::FrameReceiver::read(Transport *transport, uint32_t now) {
+  for (;;) {
+    // Parse what is already buffered before pulling more from the driver
+    for (;;) {
+      if (this->parse_())
+        return true;
+      if (!this->fill_(transport))
+        break;
+      this->lastRx_ = now;
     }
-    const uint8_t length = this->data_.size();
+    if (!this->size_ || now - this->lastRx_ <= this->idleGap_)
+      return false;
+    this->flush_();
+  }
+}
 
-    // Skip invalid start bytes
-    if (length == OFFSET_START && data != START_BYTE)
-      continue;
+void ApplianceBase::FrameReceiver::flush_() {
+  // Bytes were lost mid-frame, so the partial frame can't complete. A real frame may have
+  // started inside it (e.g. behind a corrupt length byte): rescan it like a rejected frame,
+  // dropping only the bytes ahead of the next start byte.
+  const uint16_t pending = this->size_ + this->replayEnd_ - this->replayPos_;
+  this->record_(CAPTURE_RX_FLUSHED);
+  this->resync_();
+  const uint16_t dropped = pending - (this->replayEnd_ - this->replayPos_);
+  ++this->flushed_;
+  this->flushedBytes_ += dropped;
+  ESP_LOGD(TAG, "RX: flushing stale partial frame (%u bytes dropped, %u frames total)", dropped,
+           static_cast<unsigned>(this->flushed_));
+}
 
-    // Skip invalid length bytes
-    if (length == OFFSET_LENGTH && data <= OFFSET_DATA) {
-      this->data_.clear();
-      continue;
+void ApplianceBase::FrameReceiver::setBaudRate(uint32_t baudRate) {
+  // 10 bits per character, rounded up to the next millisecond
+  this->idleGap_ = (IDLE_GAP_CHARS * 10 * 1000 + baudRate - 1) / baudRate + 1;
+}
+
+bool ApplianceBase::FrameReceiver::fill_(Transport *transport) {
+  size_t available = transport->available();
+  bool received = false;
+  // At most two contiguous spans: up to the end of the ring and after wrapping
+  while (available > 0 && this->count_ < RING_SIZE) {
+    const uint16_t tail = (this->head_ + this->count_) & (RING_SIZE - 1);
+    uint16_t span = std::min<uint16_t>(RING_SIZE - this->count_, RING_SIZE - tail);
+    span = std::min<uint16_t>(span, available);
+    span = transport->read(this->ring_ + tail, span);
+    if (!span)
+      break;
+    this->count_ += span;
+    available -= span;
+    received = true;
+  }
+  return received;
+}
+
+bool ApplianceBase::FrameReceiver::parse_() {
+  for (;;) {
+    FeedStatus status = FEED_MORE;
+    if (this->replayPos_ != this->replayEnd_) {
+      // Replay is fed in place: every byte is written at or before the position it is read from
+      this->replayPos_ += this->feed_(this->data_ + this->replayPos_, this->replayEnd_ - this->replayPos_, status);
+    } else if (this->count_) {
+      const uint16_t span = std::min<uint16_t>(this->count_, RING_SIZE - this->head_);
+      const uint16_t used = this->feed_(this->ring_ + this->head_, span, status);
+      this->head_ = (this->head_ + used) & (RING_SIZE - 1);
+      this->count_ -= used;
+    } else {
+      return false;
+    }
+    if (status == FEED_COMPLETE)
+      return true;
+    if (status == FEED_CORRUPT) {
+      this->record_(CAPTURE_RX_REJECTED);
+      this->resync_();
     }
+  }
+}
 
-    this->data_.push_back(data);
+void ApplianceBase::FrameReceiver::resync_() {
+  // A real start byte may be hidden inside the rejected frame: rescan from there
+  // instead of dropping everything, followed by the replay bytes not consumed yet.
+  const auto *start = static_cast<const uint8_t *>(memchr(this->data_ + 1, START_BYTE, this->size_ - 1));
+  uint16_t size = 0;
+  if (start != nullptr) {
+    size = this->data_ + this->size_ - start;
+    memmove(this->data_, start, size);
+  }
+  const uint16_t rest = this->replayEnd_ - this->replayPos_;
+  memmove(this->data_ + size, this->data_ + this->replayPos_, rest);
+  this->replayPos_ = 0;
+  this->replayEnd_ = size + rest;
+  this->clear();
+}
 
+uint16_t ApplianceBase::FrameReceiver::feed_(const uint8_t *data, uint16_t size, FeedStatus &status) {
+  const uint8_t *it = data;
+  const uint8_t *const end = data + size;
+  while (it != end) {
+    if (this->size_ == OFFSET_START) {
+      // Skip everything up to the next start byte
+      it = static_cast<const uint8_t *>(memchr(it, START_BYTE, end - it));
+      if (it == nullptr)
+        return size;
+      this->cs_ = 0;
+      this->crc_ = 0;
+      this->pushBack_(*it++);
+      continue;
+    }
+    if (this->size_ == OFFSET_LENGTH) {
+      // Skip invalid length bytes
+      if (*it <= OFFSET_DATA) {
+        this->clear();
+        ++it;
+        continue;
+      }
+      this->cs_ += *it;
+      this->pushBack_(*it++);
+      continue;
+    }
+    // Copy up to the checksum byte, accumulating both checks
+    const uint16_t length = this->len_();
+    const uint16_t n = std::min<uint16_t>(length + 1 - this->size_, end - it);
+    for (const uint8_t *const stop = it + n; it != stop; ++it) {
+      if (this->size_ >= OFFSET_DATA && this->size_ < length)
+        this->crc_ = CRC8::update(this->crc_, *it);
+      this->cs_ += *it;
+      this->pushBack_(*it);
+    }
     // Check if we have a complete frame
-    if (length > OFFSET_DATA && length >= this->data_[OFFSET_LENGTH]) {
-      if (this->isValid())
-        return true;
-      this->data_.clear();
+    if (this->size_ > length) {
+      status = this->isValid() ? FEED_COMPLETE : FEED_CORRUPT;
+      if (status == FEED_COMPLETE && !this->hasValidCRC()) {
+        // Framing is intact but the body is not: never hand it to the handlers
+        ++this->crcErrors_;
+        ESP_LOGW(TAG, "RX: body CRC8 mismatch, frame dropped (%u total)", static_cast<unsigned>(this->crcErrors_));
+        status = FEED_CORRUPT;
+      }
+      return it - data;
     }
   }
-  return false;
+  return size;
 }
 
 void ApplianceBase::setup() {
   this->timer_manager_.registerTimer(this->periodTimer_);
   this->timer_manager_.registerTimer(this->networkTimer_);
   this->timer_manager_.registerTimer(this->responseTimer_);
-  this->networkTimer_.setCallback([this](Timer *timer) {
-    this->sendNetworkNotify_();
-    timer->reset();
-  });
-  this->networkTimer_.start(2 * 60 * 1000);
+  this->periodTimer_.setCallback([this](Timer *timer) { this->isBusy_ = false; });
+  this->networkTimer_.setCallback([this](Timer *timer) { this->sendNetworkNotify_(); });
+  this->networkTimer_.startPeriodic(2 * 60 * 1000);
   this->networkTimer_.call();
   this->setup_();
 }
 
 void ApplianceBase::loop() {
+  // Nothing due, nothing received and no request can go out until one of those changes
+  if (!this->timer_manager_.isDue() &&
+      (this->isBusy_ || this->isWaitForResponse_() || (this->isIdle_ && this->queue_.empty())) &&
+      !this->receiver_.hasPending() && !this->transport_->available()) {
+    loop_();
+    return;
+  }
+  this->isIdle_ = false;
   // Timers task
   timer_manager_.task();
   // Loop for appliances
   loop_();
   // Frame receiving
-  while (this->receiver_.read(this->uart_device_)) {
+  while (this->receiver_.read(this->transport_, this->clock_->millis())) {
     this->protocol_ = this->receiver_.getProtocol();
     ESP_LOGD(TAG, "RX: %s", this->receiver_.toString().c_str());
+    if (this->capture_ != nullptr)
+      this->capture_->record(CAPTURE_RX, this->receiver_.data(), this->receiver_.size(), this->clock_->micros());
     this->handler_(this->receiver_);
     this->receiver_.clear();
   }
+  if (!this->isBusy_)
+    this->sendHeld_();
   if (this->isBusy_ || this->isWaitForResponse_())
     return;
 
+  const uint32_t now = this->clock_->millis();
   // Check if we have sequenced commands waiting
   if (!this->queue_.empty() && this->is_in_sequence_mode_) {
     // Check if enough time has passed for next sequenced command
-    uint32_t now = esphome::millis();
     uint32_t time_since_last = now - this->last_sequence_command_time_;
     if (time_since_last >= INTER_COMMAND_DELAY_MS) {
       ESP_LOGD(TAG, "Sequence delay satisfied, processing next sequenced command...");
@@ -93,30 +305,49 @@ void ApplianceBase::loop() {
     }
   }
 
+  // User commands may spend the burst allowance; background requests and polls keep the sustained rate
+  const bool user = this->queue_.size(PRIORITY_USER_COMMAND) || this->queue_.size(PRIORITY_USER_SEQUENCE);
+  const uint32_t wait = this->pacer_.wait(now, user);
+  if (wait) {
+    if (!this->queue_.empty())
+      this->pacer_.hold(now);
+    this->isBusy_ = true;
+    this->periodTimer_.start(wait);
+    return;
+  }
+
   if (this->queue_.empty()) {
     // Skip periodic requests if we have pending user commands
     if (!this->shouldSkipPeriodicRequests()) {
       this->onIdle_();
     }
+    // Nothing to poll yet: sleep until a timer fires, a frame arrives or a request is queued
+    this->isIdle_ = this->queue_.empty();
     return;
   }
 
   // Get next request from queue
-  this->request_ = this->queue_.front();
-  this->queue_.pop_front();
+  this->request_ = this->queue_.pop(now, REQUEST_AGING_MS);
 
   // Handle sequenced commands specially
   if (this->request_->priority == PRIORITY_USER_SEQUENCE) {
     ESP_LOGD(TAG, "Processing sequenced user command...");
-    this->last_sequence_command_time_ = esphome::millis();
+    this->last_sequence_command_time_ = now;
     this->is_in_sequence_mode_ = true; // Set flag for next command delay
   } else {
     ESP_LOGD(TAG, "Getting and sending a request from the queue...");
   }
 
-  this->sendRequest_(this->request_);
+  // A resumed request may still be answered for its interrupted attempt: no RTT sample
+  this->sendRequest_(this->request_, this->request_->remainAttempts != 0);
   if (this->request_->onData != nullptr) {
-    this->resetAttempts_();
+    if (this->request_->remainAttempts) {
+      // Resuming a preempted request with the attempts it had left
+      this->remainAttempts_ = this->request_->remainAttempts;
+      this->request_->remainAttempts = 0;
+    } else {
+      this->resetAttempts_();
+    }
     this->resetTimeout_();
   } else {
     this->destroyRequest_();
@@ -125,13 +356,21 @@ void ApplianceBase::loop() {
 
 void ApplianceBase::handler_(const Frame &frame) {
   if (this->isWaitForResponse_()) {
+    const uint32_t now = this->clock_->millis();
     auto result = this->request_->callHandler(frame);
     if (result != RESPONSE_WRONG) {
+      // Karn: a response to a resent request may belong to any of its attempts
+      if (!this->retransmitted_)
+        this->rtt_[rttIndex_(this->request_->requestType)].sample(now - this->requestSentAt_);
       if (result == RESPONSE_OK) {
         if (this->request_->onSuccess != nullptr)
           this->request_->onSuccess();
+        this->notifyWaiters_(this->request_->takeWaiters(), true);
         this->destroyRequest_();
       } else {
+        // The handler sent the follow-up frame (or it is held for the minimum gap)
+        this->requestSentAt_ = now;
+        this->retransmitted_ = false;
         this->resetAttempts_();
         this->resetTimeout_();
       }
@@ -230,6 +469,10 @@ void ApplianceBase::sendNetworkNotify_(FrameType msgType) {
   if (msgType == NETWORK_NOTIFY) {
     ESP_LOGD(TAG, "Enqueuing a DEVICE_NETWORK(0x0D) notification...");
     this->queueNotify_(msgType, std::move(notify));
+  } else if (const uint32_t gap = this->pacer_.gap(this->clock_->millis())) {
+    // Built again when sent
+    this->networkAnswerDue_ = true;
+    this->holdFor_(gap);
   } else {
     ESP_LOGD(TAG, "Answer to QUERY_NETWORK(0x63) request...");
     this->sendFrame_(msgType, std::move(notify));
@@ -240,38 +483,38 @@ void ApplianceBase::resetTimeout_() {
   this->resetTimeout_(this->timeout_);
 }
 
-void ApplianceBase::resetTimeout_(uint32_t customTimeout) {
-  this->responseTimer_.setCallback([this, customTimeout](Timer *timer) {
+void ApplianceBase::resetTimeout_(uint32_t limit) {
+  // The estimate of the frame type, backed off by the timeouts since its last sample
+  RttEstimator &rtt = this->rtt_[rttIndex_(this->request_->requestType)];
+  this->responseTimer_.setCallback([this, &rtt, limit](Timer *timer) {
     ESP_LOGD(TAG, "Response timeout...");
+    rtt.backoff();
     if (!--this->remainAttempts_) {
       if (this->request_->onError != nullptr)
         this->request_->onError();
+      this->notifyWaiters_(this->request_->takeWaiters(), false);
       this->destroyRequest_();
       return;
     }
     ESP_LOGD(TAG, "Sending request again. Attempts left: %d...", this->remainAttempts_);
-    // For user commands, use exponential backoff to avoid overwhelming the AC
-    uint32_t retryDelay = customTimeout;
-    if (this->has_pending_user_command_) {
-      retryDelay = std::min((uint16_t)(customTimeout * 2), (uint16_t)3000); // Cap at 3 seconds
-    }
-    this->sendRequest_(this->request_);
-    this->resetTimeout_(retryDelay);
+    this->sendRequest_(this->request_, true);
+    this->resetTimeout_(limit);
   });
-  this->responseTimer_.start(customTimeout);
+  this->responseTimer_.start(rtt.timeout(MIN_RESPONSE_TIMEOUT_MS, limit));
 }
 
 void ApplianceBase::destroyRequest_() {
   ESP_LOGD(TAG, "Destroying the request...");
   this->responseTimer_.stop();
-  delete this->request_;
+  this->releaseRequest_(this->request_);
   this->request_ = nullptr;
+  this->hasHeld_ = false;
   // Reset user command flag when request is destroyed
   this->has_pending_user_command_ = false;
 
   // Check if we need to schedule next sequenced command
   if (this->is_in_sequence_mode_ && !this->queue_.empty()) {
-    uint32_t now = esphome::millis();
+    uint32_t now = this->clock_->millis();
     uint32_t time_since_last_command = now - this->last_sequence_command_time_;
 
     if (time_since_last_command >= INTER_COMMAND_DELAY_MS) {
@@ -284,54 +527,171 @@ void ApplianceBase::destroyRequest_() {
       uint32_t remaining_delay = INTER_COMMAND_DELAY_MS - time_since_last_command;
       ESP_LOGD(TAG, "Scheduling next sequenced command in %d ms...", remaining_delay);
 
-      // Use a temporary timer for sequence delay
-      static Timer sequenceTimer;
-      this->timer_manager_.registerTimer(sequenceTimer);
-      sequenceTimer.setCallback([this](Timer *timer) {
+      this->timer_manager_.startOnce(this->sequenceTimer_, remaining_delay, [this](Timer *timer) {
         ESP_LOGD(TAG, "Sequence delay timer fired, enabling next command...");
         this->is_in_sequence_mode_ = false;
-        timer->stop();
       });
-      sequenceTimer.start(remaining_delay);
     }
   }
 }
 
 void ApplianceBase::sendFrame_(FrameType type, const FrameData &data) {
+  // Frames sent outside loop() (follow-up pages, resends) keep the minimum gap too
+  if (const uint32_t gap = this->pacer_.gap(this->clock_->millis())) {
+    ESP_LOGD(TAG, "Holding a frame for %u ms (minimum gap)...", gap);
+    this->held_ = data;
+    this->heldType_ = type;
+    this->hasHeld_ = true;
+    this->holdFor_(gap);
+    return;
+  }
   Frame frame(this->appType_, this->protocol_, type, data);
   ESP_LOGD(TAG, "TX: %s", frame.toString().c_str());
-  this->uart_device_->write_array(frame.data(), frame.size());
+  this->transport_->write(frame.data(), frame.size());
+  if (this->capture_ != nullptr)
+    this->capture_->record(CAPTURE_TX, frame.data(), frame.size(), this->clock_->micros());
+  this->pacer_.consume(this->clock_->millis());
+}
+
+void ApplianceBase::holdFor_(uint32_t gap) {
   this->isBusy_ = true;
-  // Reduce busy period for user commands to improve responsiveness
-  uint32_t busyPeriod = (this->has_pending_user_command_) ? (this->period_ / 2) : this->period_;
-  this->periodTimer_.setCallback([this](Timer *timer) {
-    this->isBusy_ = false;
-    timer->stop();
-  });
-  this->periodTimer_.start(busyPeriod);
+  this->periodTimer_.start(gap);
+}
+
+void ApplianceBase::sendHeld_() {
+  if (!this->hasHeld_ && !this->networkAnswerDue_)
+    return;
+  const uint32_t now = this->clock_->millis();
+  if (const uint32_t gap = this->pacer_.gap(now)) {
+    this->holdFor_(gap);
+    return;
+  }
+  if (this->hasHeld_) {
+    this->hasHeld_ = false;
+    this->sendFrame_(this->heldType_, this->held_);
+    // A held frame always belongs to the request in flight: its response time starts now
+    this->requestSentAt_ = now;
+  }
+  if (this->networkAnswerDue_) {
+    // Held again if a frame just went out
+    this->networkAnswerDue_ = false;
+    this->sendNetworkNotify_(QUERY_NETWORK);
+  }
+}
+
+ApplianceBase::Request *ApplianceBase::createRequest_(FrameType type, FrameData &data, ResponseHandler &onData,
+                                                      Handler &onSuccess, Handler &onError, RequestPriority priority) {
+  // Pool exhausted: user commands displace the newest queued background request, which fails
+  // with its merged queries (polls are issued again by their timers). The head is left alone:
+  // it may be a preempted request already partly answered. Otherwise the new request is
+  // dropped and fails at once.
+  Handler victimError;
+  Waiter *victimWaiters = nullptr;
+  if (this->requestPool_.full() && priority != PRIORITY_BACKGROUND) {
+    Request *victim = this->queue_.popBack(PRIORITY_BACKGROUND);
+    if (victim != nullptr) {
+      ESP_LOGW(TAG, "Request pool full, dropping a queued background request");
+      ++this->droppedRequests_;
+      // Its slot is needed now, its handlers run once the new request holds that slot
+      victimError = victim->onError;
+      victimWaiters = victim->takeWaiters();
+      this->releaseRequest_(victim);
+    }
+  }
+  Request *request = this->requestPool_.create(std::move(data), onData, onSuccess, onError, type, priority);
+  if (request == nullptr) {
+    ESP_LOGW(TAG, "Request pool full (%u), dropping the request", static_cast<unsigned>(this->requestPool_.capacity()));
+    ++this->droppedRequests_;
+    if (onError != nullptr)
+      onError();
+  }
+  if (victimError != nullptr)
+    victimError();
+  this->notifyWaiters_(victimWaiters, false);
+  return request;
 }
 
 void ApplianceBase::queueRequest_(FrameType type, FrameData data, ResponseHandler onData, Handler onSuccess, Handler onError, RequestPriority priority) {
   ESP_LOGD(TAG, "Enqueuing the request...");
-  this->queue_.push_back(new Request{std::move(data), std::move(onData), std::move(onSuccess), std::move(onError), type, priority});
+  Request *request = this->createRequest_(type, data, onData, onSuccess, onError, priority);
+  if (request == nullptr)
+    return;
+  this->queue_.push(request, this->clock_->millis());
+  // Let the pacer decide again: user commands may be sent sooner than the held request
+  if (priority != PRIORITY_BACKGROUND)
+    this->isBusy_ = false;
+}
+
+void ApplianceBase::queueQuery_(FrameType type, FrameData data, ResponseHandler onData, Handler onSuccess, Handler onError) {
+  const uint32_t key = type << 16 | data.data()[0] << 8 | (data.size() > 1 ? data.data()[1] : 0);
+  Request *existing = (this->request_ != nullptr && this->request_->key == key) ? this->request_ : this->queue_.find(key);
+  if (existing != nullptr) {
+    if (onSuccess == nullptr && onError == nullptr) {
+      ESP_LOGD(TAG, "Identical request already pending, dropping the duplicate...");
+      ++this->coalescedRequests_;
+      return;
+    }
+    Waiter *waiter = this->waiterPool_.create(std::move(onSuccess), std::move(onError), existing->waiters);
+    if (waiter != nullptr) {
+      ESP_LOGD(TAG, "Identical request already pending, attaching the handlers...");
+      existing->waiters = waiter;
+      ++this->coalescedRequests_;
+      return;
+    }
+  }
+  ESP_LOGD(TAG, "Enqueuing the request...");
+  Request *request = this->createRequest_(type, data, onData, onSuccess, onError, PRIORITY_BACKGROUND);
+  if (request == nullptr)
+    return;
+  request->key = key;
+  this->queue_.push(request, this->clock_->millis());
+}
+
+void ApplianceBase::notifyWaiters_(Waiter *waiter, bool success) {
+  // Detached by the caller: handlers may queue new requests
+  while (waiter != nullptr) {
+    Waiter *next = waiter->next;
+    Handler &handler = success ? waiter->onSuccess : waiter->onError;
+    if (handler != nullptr)
+      handler();
+    this->waiterPool_.destroy(waiter);
+    waiter = next;
+  }
+}
+
+void ApplianceBase::releaseRequest_(Request *request) {
+  if (request == nullptr)
+    return;
+  for (Waiter *waiter = request->waiters; waiter != nullptr;) {
+    Waiter *next = waiter->next;
+    this->waiterPool_.destroy(waiter);
+    waiter = next;
+  }
+  this->requestPool_.destroy(request);
 }
 
 void ApplianceBase::queueRequestPriority_(FrameType type, FrameData data, ResponseHandler onData, Handler onSuccess, Handler onError) {
   ESP_LOGD(TAG, "Priority request queuing...");
-  this->queue_.push_front(new Request{std::move(data), std::move(onData), std::move(onSuccess), std::move(onError), type, PRIORITY_USER_COMMAND});
+  Request *request = this->createRequest_(type, data, onData, onSuccess, onError, PRIORITY_USER_COMMAND);
+  if (request == nullptr)
+    return;
+  this->queue_.push(request, this->clock_->millis());
+  this->isBusy_ = false;
 }
 
 void ApplianceBase::sendImmediate(FrameType type, FrameData data, ResponseHandler onData, Handler onSuccess, Handler onError) {
-  if (!isBusy_ && queue_.empty()) {
+  if (!isWaitForResponse_() && queue_.empty() && pacer_.wait(this->clock_->millis(), true) == 0) {
     ESP_LOGD(TAG, "Sending immediate request...");
-    Request *req = new Request{std::move(data), std::move(onData), std::move(onSuccess), std::move(onError), type};
+    Request *req = createRequest_(type, data, onData, onSuccess, onError, PRIORITY_USER_COMMAND);
+    if (req == nullptr)
+      return;
     sendRequest_(req);
     if (req->onData != nullptr) {
+      request_ = req;
       resetAttempts_();
       resetTimeout_();
-      request_ = req;
     } else {
-      delete req;
+      requestPool_.destroy(req);
     }
   } else {
     ESP_LOGD(TAG, "Queuing priority request (not immediate)...");
@@ -342,40 +702,34 @@ void ApplianceBase::sendImmediate(FrameType type, FrameData data, ResponseHandle
 void ApplianceBase::sendUserCommand(FrameType type, FrameData data, ResponseHandler onData, Handler onSuccess, Handler onError) {
   // Mark that we have a pending user command
   has_pending_user_command_ = true;
-  last_user_command_time_ = esphome::millis();
+  last_user_command_time_ = this->clock_->millis();
 
-  // Cancel any current non-user request to prioritize user command
-  if (isWaitForResponse_() && request_ != nullptr) {
-    ESP_LOGD(TAG, "Cancelling current request for user command priority...");
-    cancelCurrentRequest();
-  }
-
-  // Clear any queued background requests to prioritize user command
-  auto it = queue_.begin();
-  while (it != queue_.end()) {
-    if ((*it)->priority == PRIORITY_BACKGROUND) {
-      ESP_LOGD(TAG, "Removing background request from queue for user command priority");
-      delete *it;
-      it = queue_.erase(it);
+  // Park a background request in flight, cancel a superseded user command
+  if (isWaitForResponse_()) {
+    if (request_->priority == PRIORITY_BACKGROUND) {
+      preemptRequest_();
     } else {
-      ++it;
+      ESP_LOGD(TAG, "Cancelling current request for user command priority...");
+      cancelCurrentRequest();
     }
   }
 
-  // Improved immediate sending logic: check if we can send immediately even if busy with background tasks
-  bool canSendImmediately = !isBusy_ || (isWaitForResponse_() && request_ == nullptr);
+  // Send at once if the pacer allows a user command now
+  bool canSendImmediately = !isWaitForResponse_() && pacer_.wait(this->clock_->millis(), true) == 0;
 
   if (canSendImmediately) {
     ESP_LOGD(TAG, "Sending user command immediately...");
-    Request *req = new Request{std::move(data), std::move(onData), std::move(onSuccess), std::move(onError), type};
+    Request *req = createRequest_(type, data, onData, onSuccess, onError, PRIORITY_USER_COMMAND);
+    if (req == nullptr)
+      return;
     sendRequest_(req);
     if (req->onData != nullptr) {
+      request_ = req;
       resetAttempts_();
       // Use shorter timeout for user commands
       resetTimeout_(USER_COMMAND_TIMEOUT_MS);
-      request_ = req;
     } else {
-      delete req;
+      requestPool_.destroy(req);
     }
   } else {
     ESP_LOGD(TAG, "Queuing user command with priority...");
@@ -384,7 +738,7 @@ void ApplianceBase::sendUserCommand(FrameType type, FrameData data, ResponseHand
 }
 
 void ApplianceBase::sendSequencedUserCommand(FrameType type, FrameData data, ResponseHandler onData, Handler onSuccess, Handler onError) {
-  uint32_t now = esphome::millis();
+  uint32_t now = this->clock_->millis();
 
   // If this is the first command in a sequence, initialize sequence tracking
   if (!is_in_sequence_mode_) {
@@ -410,25 +764,42 @@ void ApplianceBase::sendSequencedUserCommand(FrameType type, FrameData data, Res
   }
 }
 
+void ApplianceBase::preemptRequest_() {
+  ESP_LOGD(TAG, "Parking the current request for user command priority...");
+  this->responseTimer_.stop();
+  // The interrupted attempt is not counted: it is sent again when resumed
+  this->request_->remainAttempts = this->remainAttempts_;
+  this->queue_.pushFront(this->request_, this->clock_->millis());
+  this->request_ = nullptr;
+  this->remainAttempts_ = 0;
+  this->hasHeld_ = false;
+  ++this->preemptedRequests_;
+}
+
 void ApplianceBase::cancelCurrentRequest() {
   if (request_ != nullptr) {
     ESP_LOGD(TAG, "Cancelling current request...");
     responseTimer_.stop();
-    delete request_;
+    // A cancelled request fails like any other, once its slot is free
+    Handler onError = request_->onError;
+    Waiter *waiters = request_->takeWaiters();
+    releaseRequest_(request_);
     request_ = nullptr;
     remainAttempts_ = 0;
+    hasHeld_ = false;
+    if (onError != nullptr)
+      onError();
+    notifyWaiters_(waiters, false);
   }
 }
 
 bool ApplianceBase::shouldSkipPeriodicRequests() const {
   // Skip periodic requests if we have a recent user command pending or in sequence mode
   bool has_recent_user_command = has_pending_user_command_ &&
-         (esphome::millis() - last_user_command_time_) < 5000; // 5 seconds grace period
+         (this->clock_->millis() - last_user_command_time_) < 5000; // 5 seconds grace period
 
   // Also skip if we're in sequence mode (processing sequenced commands)
-  bool in_sequence = is_in_sequence_mode_ ||
-         (!queue_.empty() && std::any_of(queue_.begin(), queue_.end(),
-           [](const Request* req) { return req->priority == PRIORITY_USER_SEQUENCE; }));
+  bool in_sequence = is_in_sequence_mode_ || queue_.size(PRIORITY_USER_SEQUENCE) != 0;
 
   return has_recent_user_command || in_sequence;
 }
@@ -1,10 +1,17 @@
 #pragma once
-#include <deque>
+#include <functional>
+#include <vector>
 #include <optional>
-#include "esphome/components/uart/uart.h"
+#include "capture.h"
+#include "clock.h"
+#include "delegate.h"
 #include "frame.h"
 #include "frame_data.h"
+#include "pacer.h"
+#include "pool.h"
+#include "rtt.h"
 #include "timer.h"
+#include "transport.h"
 
 namespace esphome {
 namespace midea {
@@ -50,8 +57,8 @@ enum FrameType : uint8_t {
   QUERY_NETWORK = 0x63,
 };
 
-using Handler = std::function<void()>;
-using ResponseHandler = std::function<ResponseStatus(FrameData)>;
+using Handler = Delegate<void()>;
+using ResponseHandler = Delegate<ResponseStatus(FrameView)>;
 using OnStateCallback = std::function<void()>;
 
 class ApplianceBase {
@@ -61,19 +68,71 @@ class ApplianceBase {
   void setup();
   /// Loop
   void loop();
+  /// Milliseconds until the next timer is due (UINT32_MAX if none). While received bytes are
+  /// pending or a request can be sent, loop() has work regardless.
+  uint32_t nextDeadline() const { return this->timer_manager_.nextDeadline(); }
+  /// Number of registered timers (constant once set up)
+  size_t getTimerCount() const { return this->timer_manager_.size(); }
 
   /* ############################## */
   /* ### COMMUNICATION SETTINGS ### */
   /* ############################## */
 
-  /// Set UART device
-  void setUARTDevice(uart::UARTDevice *uart_device) { this->uart_device_ = uart_device; }
-  /// Set minimal period between requests
-  void setPeriod(uint32_t period) { this->period_ = period; }
-  uint32_t getPeriod() const { return this->period_; }
-  /// Set waiting response timeout
+  /// Set transport to the appliance
+  void setTransport(Transport *transport) { this->transport_ = transport; }
+  /// Set time source (defaults to the platform clock)
+  void setClock(const Clock *clock) {
+    this->clock_ = clock;
+    this->timer_manager_.setClock(clock);
+    this->receiver_.setCapture(this->capture_, clock);
+  }
+  /// Set capture sink for every TX/RX frame, rejected RX frames included (nullptr disables)
+  void setCapture(CaptureSink *capture) {
+    this->capture_ = capture;
+    this->receiver_.setCapture(capture, this->clock_);
+  }
+  /// Set UART baud rate (used to derive the inter-byte idle gap)
+  void setBaudRate(uint32_t baudRate) { this->receiver_.setBaudRate(baudRate); }
+  /// Number of incomplete frames flushed after the line went idle
+  uint32_t getFlushedFrames() const { return this->receiver_.getFlushed(); }
+  /// Bytes those flushes dropped; bytes from a start byte inside a stale frame are rescanned
+  uint32_t getFlushedBytes() const { return this->receiver_.getFlushedBytes(); }
+  /// Number of received frames dropped because the body failed its CRC8
+  uint32_t getCrcErrors() const { return this->receiver_.getCrcErrors(); }
+  /// Set minimal period between requests: the sustained rate of the pacer
+  void setPeriod(uint32_t period) { this->pacer_.setInterval(period); }
+  uint32_t getPeriod() const { return this->pacer_.getInterval(); }
+  /// Set number of user commands that may be sent ahead of the sustained rate
+  void setBurst(uint8_t burst) { this->pacer_.setBurst(burst); }
+  /// Set minimal gap between any two frames
+  void setMinGap(uint32_t minGap) { this->pacer_.setMinGap(minGap); }
+  /// Pacer state and the delays it imposed
+  const Pacer &getPacer() const { return this->pacer_; }
+  /// Set waiting response timeout: the upper bound of the timeout derived from measured response times
   void setTimeout(uint32_t timeout) { this->timeout_ = timeout; }
   uint32_t getTimeout() const { return this->timeout_; }
+  /// Response time estimate for requests of a frame type
+  const RttEstimator &getRtt(FrameType type) const { return this->rtt_[rttIndex_(type)]; }
+  /// Current response timeout for background requests of a frame type, backoff included
+  uint32_t getResponseTimeout(FrameType type) const { return this->getRtt(type).timeout(MIN_RESPONSE_TIMEOUT_MS, this->timeout_); }
+  /// Set request pool depth: queued plus in-flight requests (call before setup)
+  void setQueueSize(uint8_t size) {
+    this->requestPool_.setCapacity(size);
+    this->waiterPool_.setCapacity(size);
+  }
+  uint8_t getQueueSize() const { return this->requestPool_.capacity(); }
+  /// Most requests alive at once, for sizing the pool
+  uint8_t getQueueHighWater() const { return this->requestPool_.highWater(); }
+  /// Requests dropped because the pool was full
+  uint32_t getDroppedRequests() const { return this->droppedRequests_; }
+  /// Background requests parked in flight to let a user command through
+  uint32_t getPreemptedRequests() const { return this->preemptedRequests_; }
+  /// Queries merged into an identical request already queued or in flight
+  uint32_t getCoalescedRequests() const { return this->coalescedRequests_; }
+  /// Requests waiting in a priority class
+  uint8_t getQueueDepth(RequestPriority priority) const { return this->queue_.size(priority); }
+  /// Milliseconds the oldest request of a priority class has been waiting (0 if none)
+  uint32_t getQueueAge(RequestPriority priority) const { return this->queue_.age(priority, this->clock_->millis()); }
   /// Set number of request attempts
   void setNumAttempts(uint8_t numAttempts) { this->numAttempts_ = numAttempts; }
   uint8_t getNumAttempts() const { return this->numAttempts_; }
@@ -93,18 +152,27 @@ class ApplianceBase {
 
  protected:
   std::vector<OnStateCallback> state_callbacks_;
+  // Time source
+  const Clock *clock_{&SystemClock::instance()};
   // Timer manager
   TimerManager timer_manager_;
-  AutoconfStatus autoconf_status_;
+  AutoconfStatus autoconf_status_{AUTOCONF_DISABLED};
   // Beeper feedback flag
-  bool beeper_;
+  bool beeper_{};
   // User command tracking
-  bool has_pending_user_command_;
-  uint32_t last_user_command_time_;
+  bool has_pending_user_command_{};
+  uint32_t last_user_command_time_{};
   // Sequenced command tracking
-  bool is_in_sequence_mode_;
-  uint32_t sequence_start_time_;
-  uint32_t last_sequence_command_time_;
+  bool is_in_sequence_mode_{};
+  uint32_t sequence_start_time_{};
+  uint32_t last_sequence_command_time_{};
+
+  // Completion handlers of a duplicate query merged into a queued or in-flight request
+  struct Waiter {
+    Handler onSuccess;
+    Handler onError;
+    Waiter *next;
+  };
 
   struct Request {
     FrameData request;
@@ -113,10 +181,61 @@ class ApplianceBase {
     Handler onError;
     FrameType requestType;
     RequestPriority priority;
+    // Next request in the queue
+    Request *next{nullptr};
+    // Time the request was queued
+    uint32_t queuedAt{};
+    // Identity for coalescing: frame type and body ID (0: never merged)
+    uint32_t key{};
+    // Attempts left when preempted by a user command (0: not sent yet)
+    uint8_t remainAttempts{};
+    // Duplicate queries merged into this one
+    Waiter *waiters{nullptr};
     ResponseStatus callHandler(const Frame &data);
+    /// Detach the merged queries, e.g. before running their handlers
+    Waiter *takeWaiters() {
+      Waiter *waiters = this->waiters;
+      this->waiters = nullptr;
+      return waiters;
+    }
+  };
+
+  /// One FIFO of pooled requests per priority class, linked through Request::next. User
+  /// commands go first, then sequenced commands, then background requests, except that a
+  /// request waiting longer than the aging limit is served ahead of every class.
+  class RequestScheduler {
+   public:
+    bool empty() const { return this->size_ == 0; }
+    uint8_t size() const { return this->size_; }
+    uint8_t size(RequestPriority priority) const { return this->queues_[priority].size; }
+    /// Milliseconds the oldest request of a class has been waiting (0 if none)
+    uint32_t age(RequestPriority priority, uint32_t now) const;
+    void push(Request *request, uint32_t now);
+    /// Queue ahead of its class, for resuming a preempted request
+    void pushFront(Request *request, uint32_t now);
+    /// Unlink and return the next request to send, nullptr if none
+    Request *pop(uint32_t now, uint32_t agingLimit);
+    /// Unlink and return the head of a class, nullptr if none
+    Request *pop(RequestPriority priority);
+    /// Unlink and return the newest request of a class behind its head, nullptr if none
+    Request *popBack(RequestPriority priority);
+    /// Queued request with identity `key`, nullptr if none
+    Request *find(uint32_t key) const;
+   private:
+    struct Fifo {
+      Request *head{nullptr};
+      Request *tail{nullptr};
+      uint8_t size{};
+    };
+    Fifo queues_[PRIORITY_USER_SEQUENCE + 1];
+    uint8_t size_{};
   };
 
-  void queueNotify_(FrameType type, FrameData data) { this->queueRequest_(type, std::move(data), nullptr); }
+  void queueNotify_(FrameType type, FrameData data) { this->queueQuery_(type, std::move(data), nullptr); }
+  /// Queue a background query unless one with the same frame type and body ID is already queued
+  /// or in flight. Its onSuccess/onError then run when that request completes; the response is
+  /// decoded once, by the onData of the request already there.
+  void queueQuery_(FrameType type, FrameData data, ResponseHandler onData, Handler onSuccess = nullptr, Handler onError = nullptr);
   void queueRequest_(FrameType type, FrameData data, ResponseHandler onData, Handler onSuccess = nullptr, Handler onError = nullptr, RequestPriority priority = PRIORITY_BACKGROUND);
   void queueRequestPriority_(FrameType type, FrameData data, ResponseHandler onData = nullptr, Handler onSuccess = nullptr, Handler onError = nullptr);
   void sendImmediate(FrameType type, FrameData data, ResponseHandler onData = nullptr, Handler onSuccess = nullptr, Handler onError = nullptr);
@@ -136,54 +255,160 @@ class ApplianceBase {
  private:
   class FrameReceiver : public Frame {
   public:
-    bool read(uart::UARTDevice *uart_device);
-    void clear() { this->data_.clear(); }
+    bool read(Transport *transport, uint32_t now);
+    void clear() { this->size_ = 0; }
+    void setBaudRate(uint32_t baudRate);
+    /// Sink for rejected frames and flushed partial frames (nullptr disables)
+    void setCapture(CaptureSink *capture, const Clock *clock) {
+      this->capture_ = capture;
+      this->clock_ = clock;
+    }
+    uint32_t getFlushed() const { return this->flushed_; }
+    uint32_t getFlushedBytes() const { return this->flushedBytes_; }
+    uint32_t getCrcErrors() const { return this->crcErrors_; }
+    /// Buffered bytes, a frame being replayed or a partial frame awaiting the idle gap
+    bool hasPending() const { return this->count_ || this->replayPos_ != this->replayEnd_ || this->size_; }
+    // Both checks are accumulated while bytes arrive, so these are O(1)
+    bool isValid() const { return !this->cs_; }
+    bool hasValidCRC() const { return !this->crc_; }
+  private:
+    // Raw UART bytes waiting to be parsed (power of two)
+    static constexpr uint16_t RING_SIZE = 256;
+    enum FeedStatus : uint8_t {
+      FEED_MORE,
+      FEED_COMPLETE,
+      FEED_CORRUPT,
+    };
+    bool fill_(Transport *transport);
+    bool parse_();
+    uint16_t feed_(const uint8_t *data, uint16_t size, FeedStatus &status);
+    void resync_();
+    void flush_();
+    void record_(CaptureDirection kind) {
+      if (this->capture_ != nullptr)
+        this->capture_->record(kind, this->data_, this->size_, this->clock_->micros());
+    }
+    // Line idle time, in characters, after which a partial frame is considered stale.
+    // Must exceed the UART driver RX timeout (10 characters on ESP-IDF).
+    static constexpr uint32_t IDLE_GAP_CHARS = 16;
+    uint8_t ring_[RING_SIZE];
+    uint16_t head_{};
+    uint16_t count_{};
+    // Bytes of a rejected frame queued for rescanning, kept in place at data_[replayPos_, replayEnd_)
+    uint16_t replayPos_{};
+    uint16_t replayEnd_{};
+    // Running additive checksum from the LENGTH byte on
+    uint8_t cs_{};
+    // Running CRC8 over the body including its CRC byte
+    uint8_t crc_{};
+    // Time of the last received chunk
+    uint32_t lastRx_{};
+    // Inter-byte idle gap in ms (16 characters at 9600 baud by default)
+    uint32_t idleGap_{18};
+    // Stale partial frames flushed, and the bytes dropped by those flushes
+    uint32_t flushed_{};
+    uint32_t flushedBytes_{};
+    // Frames with a valid checksum and a bad body CRC8, dropped
+    uint32_t crcErrors_{};
+    CaptureSink *capture_{nullptr};
+    const Clock *clock_{&SystemClock::instance()};
   };
   void sendNetworkNotify_(FrameType msg_type = NETWORK_NOTIFY);
   void handler_(const Frame &frame);
   inline bool isWaitForResponse_() const { return this->request_ != nullptr; }
   void resetAttempts_() { this->remainAttempts_ = this->numAttempts_; }
   void destroyRequest_();
+  void preemptRequest_();
+  /// Return a request and its waiters to their pools
+  void releaseRequest_(Request *request);
+  /// Run the handlers of detached merged queries and return them to the pool
+  void notifyWaiters_(Waiter *waiters, bool success);
   void resetTimeout_();
-  void resetTimeout_(uint32_t customTimeout);
-  void sendRequest_(Request *request) { this->sendFrame_(request->requestType, request->request); }
-  // Frame receiver with dynamic buffer
+  /// Arm the response timer from the response time estimate, bounded by `limit`
+  void resetTimeout_(uint32_t limit);
+  void sendRequest_(Request *request, bool retry = false) {
+    this->sendFrame_(request->requestType, request->request);
+    this->requestSentAt_ = this->clock_->millis();
+    this->retransmitted_ = retry;
+  }
+  /// Wake loop() once `gap` ms have passed, to send a held frame
+  void holdFor_(uint32_t gap);
+  /// Send the frame held for the minimum gap, then the held QUERY_NETWORK answer
+  void sendHeld_();
+  static uint8_t rttIndex_(FrameType type) { return type == DEVICE_CONTROL ? 0 : type == DEVICE_QUERY ? 1 : 2; }
+  Request *createRequest_(FrameType type, FrameData &data, ResponseHandler &onData, Handler &onSuccess,
+                          Handler &onError, RequestPriority priority);
+  // Frame receiver with inline buffer
   FrameReceiver receiver_{};
   // Network status timer
   Timer networkTimer_{};
   // Waiting response timer
   Timer responseTimer_{};
-  // Request period timer
+  // Wakes the loop when the pacer allows the next frame
   Timer periodTimer_{};
-  // Queue requests
-  std::deque<Request *> queue_;
+  // UART transmit pacing
+  Pacer pacer_{};
+  // Delay between sequenced user commands
+  Timer sequenceTimer_{};
+  // Storage of queued and in-flight requests
+  Pool<Request> requestPool_{DEFAULT_QUEUE_SIZE};
+  // Queued requests
+  RequestScheduler queue_;
+  // Requests dropped on pool overflow
+  uint32_t droppedRequests_{};
+  // Background requests parked for user commands
+  uint32_t preemptedRequests_{};
+  // Handlers of merged duplicate queries
+  Pool<Waiter> waiterPool_{DEFAULT_QUEUE_SIZE};
+  // Duplicate queries merged
+  uint32_t coalescedRequests_{};
   // Current request
   Request *request_{nullptr};
   // Remaining request attempts
   uint8_t remainAttempts_{};
+  // Response time estimators: DEVICE_CONTROL, DEVICE_QUERY, other frame types
+  RttEstimator rtt_[3];
+  // Time the current request was last sent
+  uint32_t requestSentAt_{};
+  // The current request was sent more than once: its response time is ambiguous
+  bool retransmitted_{};
+  // Frame of the request in flight, sent outside loop() within the minimum gap of the last one
+  FrameData held_{FrameData(uint8_t{0})};
+  FrameType heldType_{};
+  bool hasHeld_{};
+  // QUERY_NETWORK arrived within the minimum gap of the last frame: answer once it has passed
+  bool networkAnswerDue_{};
   // Appliance type
   ApplianceType appType_;
   // Appliance protocol
   uint8_t protocol_{};
-  // Period flag
+  // Sending held back by the pacer until periodTimer_ fires
   bool isBusy_{};
+  // Idle with nothing queued: loop() has no work until a timer, a frame or a request
+  bool isIdle_{};
 
   /* ############################## */
   /* ### COMMUNICATION SETTINGS ### */
   /* ############################## */
 
-  // UART device interface
-  uart::UARTDevice *uart_device_;
-  // Minimal period between requests
-  uint32_t period_{1000};
+  // Transport to the appliance
+  Transport *transport_{nullptr};
+  // Session capture
+  CaptureSink *capture_{nullptr};
   // Waiting response timeout (default for background requests)
   uint32_t timeout_{2000};
   // User command timeout (shorter for responsiveness, but not too aggressive)
   static constexpr uint32_t USER_COMMAND_TIMEOUT_MS = 1200;
+  // Lower bound of the measured response timeout
+  static constexpr uint32_t MIN_RESPONSE_TIMEOUT_MS = 250;
   // Inter-command delay for sequenced user commands
   static constexpr uint32_t INTER_COMMAND_DELAY_MS = 600;
+  // Longest a queued request may be passed over by higher priority classes
+  static constexpr uint32_t REQUEST_AGING_MS = 10000;
   // Number of request attempts
   uint8_t numAttempts_{3};
+  // Default request pool depth
+  static constexpr uint8_t DEFAULT_QUEUE_SIZE = 8;
 };
 
 }  // namespace midea
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+namespace midea {
+
+/// Polling interval with exponential backoff: reset() after activity brings it back to the
+/// minimum, backoff() after a quiet reading doubles it, up to the maximum.
+class PollCadence {
+ public:
+  PollCadence(uint32_t minimum, uint32_t maximum) { this->setRange(minimum, maximum); }
+  void setRange(uint32_t minimum, uint32_t maximum) {
+    this->minimum_ = minimum;
+    this->maximum_ = maximum < minimum ? minimum : maximum;
+    this->interval_ = minimum;
+  }
+  uint32_t interval() const { return this->interval_; }
+  uint32_t getMinimum() const { return this->minimum_; }
+  uint32_t getMaximum() const { return this->maximum_; }
+  void reset() { this->interval_ = this->minimum_; }
+  void backoff() { this->interval_ = this->interval_ > this->maximum_ / 2 ? this->maximum_ : this->interval_ * 2; }
+
+ private:
+  uint32_t minimum_;
+  uint32_t maximum_;
+  uint32_t interval_;
+};
+
+}  // namespace midea
+}  // namespace esphome
@@ -1,6 +1,6 @@
 #include "capabilities.h"
 #include "frame_data.h"
-#include "esphome/core/log.h"
+#include "port.h"
 
 namespace esphome {
 namespace midea {
@@ -37,7 +37,7 @@ static uint16_t read_u16(const uint8_t *data) { return (data[1] << 8) | data[0];
 
 class CapabilityData {
  public:
-  CapabilityData(const FrameData &data) :
+  CapabilityData(const FrameView &data) :
     it_(data.data() + 2),
     end_(data.data() + data.size() - 1),
     num_(*(data.data() + 1)) {}
@@ -66,7 +66,7 @@ class CapabilityData {
   uint8_t num_;
 };
 
-bool Capabilities::read(const FrameData &frame) {
+bool Capabilities::read(const FrameView &frame) {
   if (frame.size() < 14)
     return false;
 
@@ -4,14 +4,14 @@
 namespace esphome {
 namespace midea {
 
-class FrameData;
+class FrameView;
 
 namespace ac {
 
 class Capabilities {
  public:
   // Read from frames
-  bool read(const FrameData &data);
+  bool read(const FrameView &data);
   // Dump capabilities
   void dump() const;
 
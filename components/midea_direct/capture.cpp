@@ -0,0 +1,152 @@
+#include "capture.h"
+#include <algorithm>
+#include <cstring>
+#include "port.h"
+
+namespace esphome {
+namespace midea {
+
+static const char *TAG = "Capture";
+
+namespace capture {
+
+void writeHeader(uint8_t *out, uint32_t base) {
+  memcpy(out, MAGIC, sizeof(MAGIC));
+  out[4] = VERSION;
+  out[5] = out[6] = out[7] = 0;
+  for (uint8_t i = 0; i < 4; ++i)
+    out[8 + i] = base >> (8 * i);
+}
+
+size_t writeRecordHeader(uint8_t *out, CaptureDirection direction, uint32_t delta, uint16_t size) {
+  uint8_t *it = out;
+  *it++ = direction;
+  do {
+    *it = delta & 0x7F;
+    delta >>= 7;
+    if (delta)
+      *it |= 0x80;
+    ++it;
+  } while (delta);
+  *it++ = size - 1;
+  return it - out;
+}
+
+}  // namespace capture
+
+void Capture::record(CaptureDirection direction, const uint8_t *data, uint16_t size, uint32_t timestamp) {
+  if (!size)
+    return;
+  if (!this->count_)
+    this->base_ = this->last_ = timestamp;
+  uint8_t header[capture::MAX_RECORD_HEADER];
+  const size_t headerSize = capture::writeRecordHeader(header, direction, timestamp - this->last_, size);
+  const size_t need = headerSize + size;
+  if (need > this->capacity_)
+    return;
+  while (this->capacity_ - this->count_ < need)
+    this->dropOldest_();
+  if (!this->count_)
+    this->base_ = this->last_;
+  this->put_(header, headerSize);
+  this->put_(data, size);
+  this->last_ = timestamp;
+}
+
+void Capture::put_(const uint8_t *data, size_t size) {
+  size_t tail = (this->head_ + this->count_) % this->capacity_;
+  this->count_ += size;
+  while (size) {
+    const size_t span = std::min(size, this->capacity_ - tail);
+    memcpy(this->buffer_.get() + tail, data, span);
+    data += span;
+    size -= span;
+    tail = 0;
+  }
+}
+
+void Capture::dropOldest_() {
+  // Parse the oldest record header to learn its delta and length
+  size_t offset = 1;
+  uint32_t delta = 0;
+  for (uint8_t shift = 0;; shift += 7) {
+    const uint8_t byte = this->at_(offset++);
+    delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      break;
+  }
+  const size_t total = offset + 1 + this->at_(offset) + 1;
+  this->base_ += delta;
+  this->head_ = (this->head_ + total) % this->capacity_;
+  this->count_ -= total;
+  ++this->dropped_;
+}
+
+size_t Capture::serialize(uint8_t *out) const {
+  capture::writeHeader(out, this->base_);
+  for (size_t i = 0; i < this->count_; ++i)
+    out[capture::HEADER_SIZE + i] = this->at_(i);
+  return capture::HEADER_SIZE + this->count_;
+}
+
+void Capture::dump() const {
+  static const size_t LINE = 64;
+  static const char HEX[] = "0123456789ABCDEF";
+  uint8_t header[capture::HEADER_SIZE];
+  capture::writeHeader(header, this->base_);
+  const size_t total = capture::HEADER_SIZE + this->count_;
+  ESP_LOGI(TAG, "CAPTURE BEGIN %u bytes, %u records dropped", static_cast<unsigned>(total),
+           static_cast<unsigned>(this->dropped_));
+  char line[LINE * 2 + 1];
+  for (size_t offset = 0; offset < total; offset += LINE) {
+    const size_t size = std::min(LINE, total - offset);
+    for (size_t i = 0; i < size; ++i) {
+      const size_t pos = offset + i;
+      const uint8_t byte = pos < capture::HEADER_SIZE ? header[pos] : this->at_(pos - capture::HEADER_SIZE);
+      line[2 * i] = HEX[byte >> 4];
+      line[2 * i + 1] = HEX[byte & 15];
+    }
+    line[2 * size] = '\0';
+    ESP_LOGI(TAG, "CAPTURE %06X: %s", static_cast<unsigned>(offset), line);
+  }
+  ESP_LOGI(TAG, "CAPTURE END");
+}
+
+CaptureReader::CaptureReader(const uint8_t *data, size_t size) : begin_(data), it_(data), end_(data + size) {
+  if (size < capture::HEADER_SIZE || memcmp(data, capture::MAGIC, sizeof(capture::MAGIC)) ||
+      data[4] < 1 || data[4] > capture::VERSION)
+    return;
+  for (uint8_t i = 0; i < 4; ++i)
+    this->time_ |= static_cast<uint32_t>(data[8 + i]) << (8 * i);
+  this->it_ += capture::HEADER_SIZE;
+  this->valid_ = true;
+}
+
+bool CaptureReader::next(Record &record) {
+  if (!this->valid_ || this->it_ == this->end_)
+    return false;
+  const uint8_t *it = this->it_;
+  record.direction = static_cast<CaptureDirection>(*it++ & 7);
+  uint32_t delta = 0;
+  for (uint8_t shift = 0;; shift += 7) {
+    if (it == this->end_ || shift > 28)
+      return false;
+    const uint8_t byte = *it++;
+    delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      break;
+  }
+  if (it == this->end_)
+    return false;
+  record.size = *it++ + 1;
+  if (static_cast<size_t>(this->end_ - it) < record.size)
+    return false;
+  record.data = it;
+  this->time_ += delta;
+  record.timestamp = this->time_;
+  this->it_ = it + record.size;
+  return true;
+}
+
+}  // namespace midea
+}  // namespace esphome
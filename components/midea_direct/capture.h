@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esphome {
+namespace midea {
+
+/*
+ * Compact UART session capture.
+ *
+ * Header (12 bytes): "MCAP", version, 3 reserved bytes, base time (u32 LE, µs).
+ * Records: flags (bit 0: TX, bit 1: rejected RX frame, bit 2: flushed RX partial frame),
+ * time delta from the previous record (LEB128 varint, µs), frame size - 1 (u8), raw frame
+ * bytes. The first record's time is base + its delta. Version 1 captures have no bits 1-2.
+ *
+ * Rejected and flushed records hold bytes the receiver rescans for a start byte, so their
+ * tail may be captured again in a later record.
+ */
+
+/// Record kind, stored as the record flags
+enum CaptureDirection : uint8_t {
+  CAPTURE_RX = 0,
+  CAPTURE_TX = 1,
+  // Complete RX frame that failed its checksum or body CRC8
+  CAPTURE_RX_REJECTED = 2,
+  // Partial RX frame flushed after the line went idle
+  CAPTURE_RX_FLUSHED = 4,
+};
+
+/// Destination of captured frames
+class CaptureSink {
+ public:
+  virtual ~CaptureSink() = default;
+  virtual void record(CaptureDirection direction, const uint8_t *data, uint16_t size, uint32_t timestamp) = 0;
+};
+
+namespace capture {
+
+static constexpr uint8_t MAGIC[4] = {'M', 'C', 'A', 'P'};
+static constexpr uint8_t VERSION = 2;
+static constexpr size_t HEADER_SIZE = 12;
+// Flags, 5-byte varint, size
+static constexpr size_t MAX_RECORD_HEADER = 7;
+
+/// Write the file header
+void writeHeader(uint8_t *out, uint32_t base);
+/// Encode a record header, returns its size
+size_t writeRecordHeader(uint8_t *out, CaptureDirection direction, uint32_t delta, uint16_t size);
+
+}  // namespace capture
+
+/// In-memory capture ring: the oldest records are dropped when it is full
+class Capture : public CaptureSink {
+ public:
+  explicit Capture(size_t size) : buffer_(new uint8_t[size]), capacity_(size) {}
+  void record(CaptureDirection direction, const uint8_t *data, uint16_t size, uint32_t timestamp) override;
+  void clear() { this->head_ = this->count_ = 0; }
+  /// Bytes used by records
+  size_t size() const { return this->count_; }
+  /// Records dropped to make room
+  uint32_t getDropped() const { return this->dropped_; }
+  /// Serialize header and records to `out` (at least HEADER_SIZE + size() bytes)
+  size_t serialize(uint8_t *out) const;
+  /// Log the serialized capture as hex lines ("CAPTURE <offset>: <hex>")
+  void dump() const;
+ protected:
+  uint8_t at_(size_t offset) const { return this->buffer_[(this->head_ + offset) % this->capacity_]; }
+  void put_(const uint8_t *data, size_t size);
+  void dropOldest_();
+  std::unique_ptr<uint8_t[]> buffer_;
+  size_t capacity_;
+  size_t head_{};
+  size_t count_{};
+  // Time preceding the oldest record (its delta is relative to this)
+  uint32_t base_{};
+  // Time of the newest record
+  uint32_t last_{};
+  uint32_t dropped_{};
+};
+
+/// Sequential reader of a serialized capture
+class CaptureReader {
+ public:
+  struct Record {
+    CaptureDirection direction;
+    // µs since an arbitrary origin; 64-bit so long captures don't wrap
+    uint64_t timestamp;
+    const uint8_t *data;
+    uint16_t size;
+  };
+  /// Resume point: byte offset of a record and the time preceding it
+  struct Position {
+    size_t offset;
+    uint64_t time;
+  };
+  CaptureReader(const uint8_t *data, size_t size);
+  bool isValid() const { return this->valid_; }
+  /// Read the next record, false at the end or on a truncated record
+  bool next(Record &record);
+  Position tell() const { return {static_cast<size_t>(this->it_ - this->begin_), this->time_}; }
+  void seek(const Position &position) {
+    this->it_ = this->begin_ + position.offset;
+    this->time_ = position.time;
+  }
+ protected:
+  const uint8_t *begin_;
+  const uint8_t *it_;
+  const uint8_t *end_;
+  uint64_t time_{};
+  bool valid_{};
+};
+
+}  // namespace midea
+}  // namespace esphome
@@ -31,6 +31,10 @@ CONF_OUTDOOR_TEMPERATURE = "outdoor_temperature"
 CONF_INDOOR_HUMIDITY = "indoor_humidity"
 CONF_CUSTOM_FAN_MODES = "custom_fan_modes"
 CONF_CUSTOM_PRESETS = "custom_presets"
+CONF_CAPTURE_SIZE = "capture_size"
+CONF_QUEUE_SIZE = "queue_size"
+CONF_BURST = "burst"
+CONF_MIN_GAP = "min_gap"
 
 midea_ns = cg.esphome_ns.namespace("midea_direct")
 MideaClimate = midea_ns.class_("MideaClimate", climate.Climate, cg.Component, uart.UARTDevice)
@@ -81,8 +85,13 @@ CONFIG_SCHEMA = climate.climate_schema(MideaClimate).extend({
     cv.Optional(CONF_PERIOD, default="1s"): cv.time_period,
     cv.Optional(CONF_TIMEOUT, default="2s"): cv.time_period, 
     cv.Optional(CONF_NUM_ATTEMPTS, default=3): cv.int_range(min=1, max=5),
+    cv.Optional(CONF_BURST, default=2): cv.int_range(min=0, max=5),
+    cv.Optional(CONF_MIN_GAP, default="100ms"): cv.time_period,
     cv.Optional(CONF_AUTOCONF, default=True): cv.boolean,
     cv.Optional(CONF_BEEPER, default=False): cv.boolean,
+    # UART session capture buffer in bytes (0 disables), dumped with dump_capture()
+    cv.Optional(CONF_CAPTURE_SIZE, default=0): cv.int_range(min=0, max=65536),
+    cv.Optional(CONF_QUEUE_SIZE, default=8): cv.int_range(min=2, max=64),
     
     # Mode support
     cv.Optional(CONF_SUPPORTED_MODES): cv.ensure_list(cv.enum(SUPPORTED_CLIMATE_MODES, upper=True)),
@@ -124,8 +133,13 @@ async def to_code(config):
     cg.add(var.set_period(config[CONF_PERIOD].total_milliseconds))
     cg.add(var.set_timeout(config[CONF_TIMEOUT].total_milliseconds))
     cg.add(var.set_num_attempts(config[CONF_NUM_ATTEMPTS]))
+    cg.add(var.set_burst(config[CONF_BURST]))
+    cg.add(var.set_min_gap(config[CONF_MIN_GAP].total_milliseconds))
     cg.add(var.set_autoconf(config[CONF_AUTOCONF]))
     cg.add(var.set_beeper_config(config[CONF_BEEPER]))
+    cg.add(var.set_queue_size(config[CONF_QUEUE_SIZE]))
+    if config[CONF_CAPTURE_SIZE] > 0:
+        cg.add(var.set_capture_size(config[CONF_CAPTURE_SIZE]))
     
     # Set supported modes if specified
     if CONF_SUPPORTED_MODES in config:
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include "port.h"
+
+namespace esphome {
+namespace midea {
+
+/// Time source of the engine. Timers, request timing and the receiver idle gap all read it,
+/// so tests and simulations can step time explicitly instead of waiting for it.
+class Clock {
+ public:
+  virtual ~Clock() = default;
+  /// Milliseconds since an arbitrary origin
+  virtual uint32_t millis() const = 0;
+  /// Microseconds since an arbitrary origin
+  virtual uint32_t micros() const = 0;
+};
+
+/// Platform clock (default)
+class SystemClock : public Clock {
+ public:
+  uint32_t millis() const override { return port::millis(); }
+  uint32_t micros() const override { return port::micros(); }
+  static SystemClock &instance() {
+    static SystemClock clock;
+    return clock;
+  }
+};
+
+/// Clock that only moves when told to
+class ManualClock : public Clock {
+ public:
+  uint32_t millis() const override { return this->now_ / 1000; }
+  uint32_t micros() const override { return this->now_; }
+  void advance(uint32_t ms) { this->now_ += ms * 1000ULL; }
+  void advanceMicros(uint32_t us) { this->now_ += us; }
+ protected:
+  uint64_t now_{};
+};
+
+}  // namespace midea
+}  // namespace esphome
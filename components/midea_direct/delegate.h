@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace esphome {
+namespace midea {
+
+template<typename Signature> class Delegate;
+
+/// Non-allocating callback: the callable is stored inline, so creating, copying and calling
+/// a delegate never touches the heap. It accepts lambdas and function objects that are
+/// trivially copyable and fit in CAPACITY bytes (a `this` pointer plus a couple of values);
+/// anything larger fails to compile instead of silently allocating.
+template<typename R, typename... Args> class Delegate<R(Args...)> {
+ public:
+  static constexpr size_t CAPACITY = 3 * sizeof(void *);
+
+  Delegate() = default;
+  Delegate(std::nullptr_t) {}
+  template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Delegate>::value &&
+                                                   !std::is_same<std::decay_t<F>, std::nullptr_t>::value>>
+  Delegate(F fn) {
+    static_assert(sizeof(F) <= CAPACITY, "Callable too large for Delegate");
+    static_assert(alignof(F) <= alignof(void *), "Callable over-aligned for Delegate");
+    static_assert(std::is_trivially_copyable<F>::value, "Delegate callables must be trivially copyable");
+    new (this->storage_) F(fn);
+    this->invoke_ = [](const void *storage, Args... args) -> R {
+      return (*static_cast<const F *>(storage))(std::forward<Args>(args)...);
+    };
+  }
+
+  R operator()(Args... args) const { return this->invoke_(this->storage_, std::forward<Args>(args)...); }
+  explicit operator bool() const { return this->invoke_ != nullptr; }
+  friend bool operator==(const Delegate &delegate, std::nullptr_t) { return delegate.invoke_ == nullptr; }
+  friend bool operator!=(const Delegate &delegate, std::nullptr_t) { return delegate.invoke_ != nullptr; }
+
+ private:
+  alignas(void *) unsigned char storage_[CAPACITY];
+  R (*invoke_)(const void *, Args...){nullptr};
+};
+
+}  // namespace midea
+}  // namespace esphome
@@ -6,22 +6,41 @@ namespace midea {
 void Frame::setData(const FrameData &data) {
   this->trimData_();
   this->appendData_(data);
-  this->data_[OFFSET_LENGTH] = this->data_.size();
+  this->data_[OFFSET_LENGTH] = this->size_;
   this->data_[OFFSET_SYNC] = this->data_[OFFSET_LENGTH] ^ this->data_[OFFSET_APPTYPE];
-  this->appendCS_();
+  // Body sum is maintained by FrameData, only the header is summed here
+  uint8_t cs = data.sum();
+  for (uint8_t i = OFFSET_LENGTH; i < OFFSET_DATA; ++i)
+    cs += this->data_[i];
+  this->pushBack_(-cs);
 }
 
 uint8_t Frame::calcCS_() const {
-  if (this->data_.size() <= OFFSET_LENGTH)
+  if (this->size_ <= OFFSET_LENGTH)
     return -1;
 
   uint16_t cs = 0;
   // Use direct indexing for better performance
-  for (size_t i = OFFSET_LENGTH; i < this->data_.size(); ++i)
+  for (uint16_t i = OFFSET_LENGTH; i < this->size_; ++i)
     cs -= this->data_[i];
   return cs & 0xFF;
 }
 
+Frame::Hex Frame::toString() const {
+  static const char DIGITS[] = "0123456789ABCDEF";
+  Hex hex;
+  char *out = hex.str;
+  for (uint16_t i = 0; i < this->size_; ++i) {
+    *out++ = DIGITS[this->data_[i] >> 4];
+    *out++ = DIGITS[this->data_[i] & 0x0F];
+    *out++ = ' ';
+  }
+  // Drop the trailing space
+  if (out != hex.str)
+    --out;
+  *out = '\0';
+  return hex;
+}
 
 }  // namespace midea
 }  // namespace esphome
@@ -1,8 +1,5 @@
 #pragma once
-#include <vector>
-#include <string>
-#include <iterator>
-#include <cstdio>
+#include <cstring>
 #include "frame_data.h"
 
 namespace esphome {
@@ -10,43 +7,55 @@ namespace midea {
 
 class Frame {
  public:
+  /// Largest frame on the wire: LENGTH byte of 255 plus the trailing checksum
+  static constexpr uint16_t MAX_SIZE = 256;
   Frame() = default;
-  Frame(uint8_t appliance, uint8_t protocol, uint8_t type, const FrameData &data)
-  : data_({START_BYTE, 0x00, appliance, 0x00, 0x00, 0x00, 0x00, 0x00, protocol, type}) {
-    data_.reserve(OFFSET_DATA + data.size() + 2); // Pre-allocate for data + CRC
+  Frame(uint8_t appliance, uint8_t protocol, uint8_t type, const FrameData &data) {
+    static const uint8_t HEADER[OFFSET_DATA] = {START_BYTE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    memcpy(this->data_, HEADER, OFFSET_DATA);
+    this->data_[OFFSET_APPTYPE] = appliance;
+    this->data_[OFFSET_PROTOCOL] = protocol;
+    this->data_[OFFSET_TYPE] = type;
+    this->size_ = OFFSET_DATA;
     this->setData(data);
   }
-  FrameData getData() const { return FrameData(this->data_.data() + OFFSET_DATA, this->len_() - OFFSET_DATA); }
+  /// Frame from raw bytes on the wire (truncated to MAX_SIZE)
+  Frame(const uint8_t *data, uint16_t size) : size_(size < MAX_SIZE ? size : MAX_SIZE) {
+    memcpy(this->data_, data, this->size_);
+  }
+  /// Body as given by the LENGTH byte, bounded by the bytes held (empty for a short header)
+  FrameView getData() const {
+    const uint16_t end = this->len_() < this->size_ ? this->len_() : this->size_;
+    return FrameView(this->data_ + OFFSET_DATA, end > OFFSET_DATA ? end - OFFSET_DATA : 0);
+  }
   void setData(const FrameData &data);
   bool isValid() const { return !this->calcCS_(); }
 
-  const uint8_t *data() const { return this->data_.data(); }
-  uint8_t size() const { return this->data_.size(); }
+  const uint8_t *data() const { return this->data_; }
+  uint16_t size() const { return this->size_; }
   void setType(uint8_t value) { this->data_[OFFSET_TYPE] = value; }
   bool hasType(uint8_t value) const { return this->data_[OFFSET_TYPE] == value; }
   void setProtocol(uint8_t value) { this->data_[OFFSET_PROTOCOL] = value; }
   uint8_t getProtocol() const { return this->data_[OFFSET_PROTOCOL]; }
 
-  // Optimized toString - avoid string creation for logging
-  std::string toString() const {
-    if (this->data_.empty()) return "";
-    std::string result;
-    result.reserve(this->data_.size() * 3); // Pre-allocate for "XX " format
-    for (uint8_t byte : this->data_) {
-      char buf[4];
-      sprintf(buf, "%02X ", byte);
-      result += buf;
-    }
-    if (!result.empty()) result.pop_back(); // Remove trailing space
-    return result;
-  }
+  /// Hex dump for logs, held by value so formatting never touches the heap
+  struct Hex {
+    char str[MAX_SIZE * 3];
+    const char *c_str() const { return this->str; }
+  };
+  Hex toString() const;
 
  protected:
-  std::vector<uint8_t> data_;
-  void trimData_() { this->data_.erase(this->data_.begin() + OFFSET_DATA, this->data_.end()); }
-  void appendData_(const FrameData &data) { std::copy(data.data(), data.data() + data.size(), std::back_inserter(this->data_)); }
+  // Inline storage: frames never touch the heap
+  uint8_t data_[MAX_SIZE];
+  uint16_t size_{0};
+  void trimData_() { this->size_ = OFFSET_DATA; }
+  void appendData_(const FrameData &data) {
+    memcpy(this->data_ + this->size_, data.data(), data.size());
+    this->size_ += data.size();
+  }
+  void pushBack_(uint8_t value) { this->data_[this->size_++] = value; }
   uint8_t len_() const { return this->data_[OFFSET_LENGTH]; }
-  void appendCS_() { this->data_.push_back(this->calcCS_()); }
   uint8_t calcCS_() const;
   static constexpr uint8_t START_BYTE = 0xAA;
   static constexpr uint8_t OFFSET_START = 0;
@@ -1,50 +1,198 @@
 #pragma once
-#include <vector>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <initializer_list>
 
 namespace esphome {
 namespace midea {
 
+/// CRC8/854 lookup, usable in constant expressions
+struct CRC8 {
+  static constexpr uint8_t TABLE[256] = {
+    0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
+    0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E, 0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC,
+    0x23, 0x7D, 0x9F, 0xC1, 0x42, 0x1C, 0xFE, 0xA0, 0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+    0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D, 0x7C, 0x22, 0xC0, 0x9E, 0x1D, 0x43, 0xA1, 0xFF,
+    0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5, 0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07,
+    0xDB, 0x85, 0x67, 0x39, 0xBA, 0xE4, 0x06, 0x58, 0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+    0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6, 0xA7, 0xF9, 0x1B, 0x45, 0xC6, 0x98, 0x7A, 0x24,
+    0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B, 0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9,
+    0x8C, 0xD2, 0x30, 0x6E, 0xED, 0xB3, 0x51, 0x0F, 0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+    0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92, 0xD3, 0x8D, 0x6F, 0x31, 0xB2, 0xEC, 0x0E, 0x50,
+    0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C, 0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE,
+    0x32, 0x6C, 0x8E, 0xD0, 0x53, 0x0D, 0xEF, 0xB1, 0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+    0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49, 0x08, 0x56, 0xB4, 0xEA, 0x69, 0x37, 0xD5, 0x8B,
+    0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4, 0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16,
+    0xE9, 0xB7, 0x55, 0x0B, 0x88, 0xD6, 0x34, 0x6A, 0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+    0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7, 0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35
+  };
+  static constexpr uint8_t update(uint8_t crc, uint8_t data) { return TABLE[crc ^ data]; }
+};
+
+/// CRC8/854 of a byte span
+uint8_t crc8(const uint8_t *data, uint8_t size);
+
+/// Fixed request body encoded at compile time (kept in flash). The last body byte may be
+/// replaced per send (message ID): its CRC and sum are finished from the stored prefix state.
+template<size_t N> struct FrameTemplate {
+  // Body bytes followed by CRC8
+  uint8_t data[N + 1];
+  // CRC8 and additive sum of the first N - 1 bytes
+  uint8_t crcPrefix;
+  uint8_t sumPrefix;
+};
+
+template<size_t N> constexpr FrameTemplate<N> makeFrameTemplate(const uint8_t (&body)[N]) {
+  FrameTemplate<N> tmpl{};
+  uint8_t crc = 0;
+  uint8_t sum = 0;
+  for (size_t i = 0; i < N; ++i) {
+    if (i == N - 1) {
+      tmpl.crcPrefix = crc;
+      tmpl.sumPrefix = sum;
+    }
+    tmpl.data[i] = body[i];
+    crc = CRC8::update(crc, body[i]);
+    sum += body[i];
+  }
+  tmpl.data[N] = crc;
+  return tmpl;
+}
+
+/// Non-owning read-only view of frame body bytes. Decoding through it makes no copies.
+class FrameView {
+ public:
+  FrameView(const uint8_t *data, uint8_t size) : data_(data), size_(size) {}
+  const uint8_t *data() const { return this->data_; }
+  uint8_t size() const { return this->size_; }
+  bool hasID(uint8_t value) const { return this->data_[0] == value; }
+  bool hasStatus() const { return this->hasID(0xC0); }
+  bool hasPowerInfo() const { return this->hasID(0xC1); }
+  bool hasValidCRC() const { return !crc8(this->data_, this->size_); }
+ protected:
+  const uint8_t *data_;
+  uint8_t size_;
+  uint8_t getValue_(uint8_t idx, uint8_t mask = 255, uint8_t shift = 0) const {
+    if (idx < this->size_)
+      return (this->data_[idx] >> shift) & mask;
+    return 0;
+  }
+};
+
 class FrameData {
  public:
+  /// Largest body of a frame: 255 bytes (LENGTH byte limit) minus the 10-byte header
+  static constexpr uint8_t MAX_SIZE = 255 - 10;
   FrameData() = delete;
-  FrameData(std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end) : data_(begin, end) {}
-  FrameData(const uint8_t *data, uint8_t size) : data_(data, data + size) {}
-  FrameData(std::initializer_list<uint8_t> list) : data_(list) { data_.reserve(32); } // Pre-allocate for CRC operations
-  FrameData(uint8_t size) : data_(size, 0) { data_.reserve(size + 2); } // Pre-allocate space for CRC
-  template<typename T> T to() { return std::move(*this); }
-  const uint8_t *data() const { return this->data_.data(); }
-  uint8_t size() const { return this->data_.size(); }
+  // Bodies longer than MAX_SIZE are truncated
+  FrameData(const uint8_t *data, uint8_t size) : size_(fit_(size)), sealed_(false), dirty_(false) {
+    memcpy(this->data_, data, this->size_);
+    this->sum_ = this->calcSum_();
+  }
+  FrameData(std::initializer_list<uint8_t> list) : size_(fit_(list.size())), sealed_(false), dirty_(false) {
+    memcpy(this->data_, list.begin(), this->size_);
+    this->sum_ = this->calcSum_();
+  }
+  FrameData(uint8_t size) : size_(fit_(size)), sum_(0), sealed_(false), dirty_(false) {
+    memset(this->data_, 0, this->size_);
+  }
+  /// Sealed body from a compile-time template, with its last byte set to `last`
+  template<size_t N> FrameData(const FrameTemplate<N> &tmpl, uint8_t last) : size_(N + 1), sealed_(true), dirty_(false) {
+    static_assert(N < MAX_SIZE, "Template does not fit in a frame");
+    memcpy(this->data_, tmpl.data, N - 1);
+    const uint8_t crc = CRC8::update(tmpl.crcPrefix, last);
+    this->data_[N - 1] = last;
+    this->data_[N] = crc;
+    this->sum_ = tmpl.sumPrefix + last + crc;
+  }
+  template<size_t N> FrameData(const FrameTemplate<N> &tmpl) : FrameData(tmpl, tmpl.data[N - 1]) {}
+  // Copy only the used part of the inline buffer
+  FrameData(const FrameData &other) : size_(other.size_), sum_(other.sum_), sealed_(other.sealed_), dirty_(other.dirty_) {
+    memcpy(this->data_, other.data_, other.size_);
+  }
+  FrameData &operator=(const FrameData &other) {
+    this->size_ = other.size_;
+    this->sum_ = other.sum_;
+    this->sealed_ = other.sealed_;
+    this->dirty_ = other.dirty_;
+    memcpy(this->data_, other.data_, other.size_);
+    return *this;
+  }
+  template<typename T> T to() { return T(*this); }
+  operator FrameView() const { return FrameView(this->data_, this->size_); }
+  const uint8_t *data() const { return this->data_; }
+  uint8_t size() const { return this->size_; }
+  /// Additive sum of all bytes, kept up to date by every mutation
+  uint8_t sum() const { return this->sum_; }
   bool hasID(uint8_t value) const { return this->data_[0] == value; }
   bool hasStatus() const { return this->hasID(0xC0); }
   bool hasPowerInfo() const { return this->hasID(0xC1); }
-  void appendCRC() { this->data_.push_back(this->calcCRC_()); }
-  void updateCRC() {
-    this->data_.pop_back();
+  /// Append the CRC8; a full body is left unsealed and logged
+  void appendCRC();
+  void updateCRC() { this->seal(); }
+  /// Finish the body for sending: appends the CRC8, or refreshes it in place if any byte
+  /// changed since the last seal. The sum is already current, so this is the only pass.
+  void seal() {
+    if (this->sealed_) {
+      if (!this->dirty_)
+        return;
+      this->sum_ -= this->data_[--this->size_];
+    }
     this->appendCRC();
   }
   bool hasValidCRC() const { return !this->calcCRC_(); }
  protected:
-  std::vector<uint8_t> data_;
+  // Inline storage: frames never touch the heap
+  uint8_t data_[MAX_SIZE];
+  uint8_t size_;
+  uint8_t sum_;
+  // CRC8 is present at the end of the body
+  bool sealed_;
+  // Some byte changed after the CRC8 was computed
+  bool dirty_;
   static uint8_t id_;
   static uint8_t getID_() { return FrameData::id_++; }
   static uint8_t getRandom_() { return static_cast<uint8_t>(rand() & 0xFF); }
-  uint8_t calcCRC_() const;
+  static uint8_t fit_(size_t size) { return size < MAX_SIZE ? size : MAX_SIZE; }
+  uint8_t calcCRC_() const { return crc8(this->data_, this->size_); }
+  uint8_t calcSum_() const;
   uint8_t getValue_(uint8_t idx, uint8_t mask = 255, uint8_t shift = 0) const {
-    if (idx < this->data_.size())
+    if (idx < this->size_)
       return (this->data_[idx] >> shift) & mask;
     return 0;
   }
   void setValue_(uint8_t idx, uint8_t value, uint8_t mask = 255, uint8_t shift = 0) {
+    const uint8_t old = this->data_[idx];
     this->data_[idx] &= ~(mask << shift);
     this->data_[idx] |= (value << shift);
+    this->patch_(idx, old);
   }
   void setMask_(uint8_t idx, bool state, uint8_t mask = 255) {
+    const uint8_t old = this->data_[idx];
     if (state) {
       this->data_[idx] |= mask;
     } else {
       this->data_[idx] &= ~mask;
     }
+    this->patch_(idx, old);
+  }
+  // Overwrite bytes from `idx` on, keeping the sum current
+  void copy_(uint8_t idx, const uint8_t *data, uint8_t size) {
+    for (uint8_t i = 0; i < size; ++i) {
+      const uint8_t old = this->data_[idx + i];
+      this->data_[idx + i] = data[i];
+      this->patch_(idx + i, old);
+    }
+  }
+  // Account for a changed byte: the sum is patched, the CRC is deferred to seal()
+  void patch_(uint8_t idx, uint8_t old) {
+    const uint8_t value = this->data_[idx];
+    if (value == old)
+      return;
+    this->sum_ += value - old;
+    this->dirty_ = true;
   }
 };
 
@@ -5,6 +5,8 @@
 #include "esphome/components/uart/uart.h"
 #include "esphome/core/component.h"
 #include "air_conditioner.h"
+#include "uart_transport.h"
+#include <memory>
 #include <vector>
 #include <algorithm>
 
@@ -45,14 +47,28 @@ class MideaClimate : public climate::Climate, public Component, public uart::UAR
   void set_period(uint32_t period) { this->setPeriod(period); }
   void set_timeout(uint32_t timeout) { this->setTimeout(timeout); }
   void set_num_attempts(uint8_t attempts) { this->setNumAttempts(attempts); }
+  void set_burst(uint8_t burst) { this->setBurst(burst); }
+  void set_min_gap(uint32_t min_gap) { this->setMinGap(min_gap); }
   void set_autoconf(bool autoconf) { 
     this->setAutoconf(autoconf);
   }
   void set_beeper_config(bool beeper) { this->setBeeper(beeper); }
+  void set_queue_size(uint8_t size) { this->setQueueSize(size); }
+  void set_capture_size(size_t size) {
+    this->capture_buffer_.reset(new esphome::midea::Capture(size));
+    this->setCapture(this->capture_buffer_.get());
+  }
+  /// Log the UART session capture as hex lines (for midea_replay)
+  void dump_capture() const {
+    if (this->capture_buffer_)
+      this->capture_buffer_->dump();
+  }
   
   // UART device setup
   void setup_uart_device() {
-    this->setUARTDevice(this); // Set the UART device directly for MideaUART_v2
+    this->setTransport(&this->uart_transport_); // Route MideaUART_v2 traffic through this UART device
+    if (this->parent_ != nullptr)
+      this->setBaudRate(this->parent_->get_baud_rate());
   }
   
  protected:
@@ -74,6 +90,12 @@ class MideaClimate : public climate::Climate, public Component, public uart::UAR
   std::vector<std::string> custom_fan_modes_;
   std::vector<std::string> custom_presets_;
   
+  // UART session capture ring (optional)
+  std::unique_ptr<esphome::midea::Capture> capture_buffer_;
+
+  // Transport adapter over this UART device
+  esphome::midea::UARTTransport uart_transport_{this};
+
   // ESPHome sensors
   sensor::Sensor* power_sensor_ = nullptr;
   sensor::Sensor* outdoor_temperature_sensor_ = nullptr;
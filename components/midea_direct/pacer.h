@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+namespace midea {
+
+/// Token-bucket pacing of UART transmissions. Credit accrues at one frame per `interval` ms up to
+/// 1 + `burst` frames. User commands may spend the whole bucket back to back; background frames
+/// wait for a full bucket, so the burst stays available for the user. Two frames are never closer
+/// than `minGap` ms. Credit is kept in milliseconds.
+class Pacer {
+ public:
+  void setInterval(uint32_t interval) { this->interval_ = interval; }
+  uint32_t getInterval() const { return this->interval_; }
+  void setBurst(uint8_t burst) { this->burst_ = burst; }
+  uint8_t getBurst() const { return this->burst_; }
+  void setMinGap(uint32_t minGap) { this->minGap_ = minGap; }
+  uint32_t getMinGap() const { return this->minGap_; }
+
+  /// Milliseconds until a frame may be sent (0: now)
+  uint32_t wait(uint32_t now, bool user) const {
+    if (!this->started_)
+      return 0;
+    uint32_t wait = this->gap(now);
+    const uint32_t need = user ? this->interval_ : this->capacity_();
+    const uint32_t credit = this->credit_(now);
+    if (credit < need && need - credit > wait)
+      wait = need - credit;
+    return wait;
+  }
+  /// Milliseconds until the minimum gap since the last frame has passed (0: now)
+  uint32_t gap(uint32_t now) const {
+    if (!this->started_)
+      return 0;
+    const uint32_t elapsed = now - this->last_;
+    return elapsed < this->minGap_ ? this->minGap_ - elapsed : 0;
+  }
+  /// A queued frame was held back by wait()
+  void hold(uint32_t now) {
+    if (!this->holding_) {
+      this->holding_ = true;
+      this->heldSince_ = now;
+    }
+  }
+  /// A frame was sent
+  void consume(uint32_t now) {
+    const uint32_t credit = this->started_ ? this->credit_(now) : this->capacity_();
+    this->balance_ = credit > this->interval_ ? credit - this->interval_ : 0;
+    this->last_ = now;
+    this->started_ = true;
+    ++this->sent_;
+    if (this->holding_) {
+      const uint32_t delay = now - this->heldSince_;
+      this->holding_ = false;
+      ++this->delayed_;
+      this->totalDelay_ += delay;
+      if (delay > this->maxDelay_)
+        this->maxDelay_ = delay;
+    }
+  }
+
+  /// Frames sent
+  uint32_t getSent() const { return this->sent_; }
+  /// Frames held back by the pacer, with their total and longest delay in ms
+  uint32_t getDelayed() const { return this->delayed_; }
+  uint32_t getTotalDelay() const { return this->totalDelay_; }
+  uint32_t getMaxDelay() const { return this->maxDelay_; }
+
+ private:
+  uint32_t capacity_() const { return this->interval_ * (1 + this->burst_); }
+  uint32_t credit_(uint32_t now) const {
+    const uint32_t elapsed = now - this->last_;
+    const uint32_t capacity = this->capacity_();
+    if (this->balance_ >= capacity || elapsed >= capacity - this->balance_)
+      return capacity;
+    return this->balance_ + elapsed;
+  }
+  uint32_t interval_{1000};
+  uint32_t minGap_{100};
+  // Credit left after the last send
+  uint32_t balance_{};
+  uint32_t last_{};
+  uint32_t heldSince_{};
+  uint32_t sent_{};
+  uint32_t delayed_{};
+  uint32_t totalDelay_{};
+  uint32_t maxDelay_{};
+  uint8_t burst_{2};
+  bool started_{};
+  bool holding_{};
+};
+
+}  // namespace midea
+}  // namespace esphome
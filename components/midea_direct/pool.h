@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace esphome {
+namespace midea {
+
+/// Fixed-capacity object pool. Slots are allocated once, when the capacity is set; free slots
+/// form an intrusive list, so create() and destroy() are O(1) and never touch the heap.
+template<typename T> class Pool {
+ public:
+  explicit Pool(size_t capacity) { this->setCapacity(capacity); }
+  Pool(const Pool &) = delete;
+  Pool &operator=(const Pool &) = delete;
+  /// Resize the pool. Only allowed while no object is alive.
+  bool setCapacity(size_t capacity) {
+    if (this->used_)
+      return false;
+    this->slots_.reset(new Slot[capacity]);
+    this->capacity_ = capacity;
+    this->free_ = nullptr;
+    for (size_t i = capacity; i > 0; --i) {
+      this->slots_[i - 1].next = this->free_;
+      this->free_ = &this->slots_[i - 1];
+    }
+    return true;
+  }
+  /// Construct an object in a free slot, nullptr when the pool is exhausted
+  template<typename... Args> T *create(Args &&...args) {
+    Slot *slot = this->free_;
+    if (slot == nullptr)
+      return nullptr;
+    this->free_ = slot->next;
+    if (++this->used_ > this->highWater_)
+      this->highWater_ = this->used_;
+    return new (slot->storage) T{std::forward<Args>(args)...};
+  }
+  void destroy(T *object) {
+    if (object == nullptr)
+      return;
+    object->~T();
+    Slot *slot = reinterpret_cast<Slot *>(object);
+    slot->next = this->free_;
+    this->free_ = slot;
+    --this->used_;
+  }
+  bool full() const { return this->free_ == nullptr; }
+  size_t capacity() const { return this->capacity_; }
+  /// Objects alive
+  size_t size() const { return this->used_; }
+  /// Most objects alive at once
+  size_t highWater() const { return this->highWater_; }
+
+ private:
+  union Slot {
+    Slot() {}
+    alignas(T) unsigned char storage[sizeof(T)];
+    Slot *next;
+  };
+  std::unique_ptr<Slot[]> slots_;
+  Slot *free_{nullptr};
+  size_t capacity_{};
+  size_t used_{};
+  size_t highWater_{};
+};
+
+}  // namespace midea
+}  // namespace esphome
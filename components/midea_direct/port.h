@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+// Platform seam: clock and logging. On the device these map to ESPHome; a host build
+// defines MIDEA_HOST and provides "host_port.h" with the same ESP_LOG* macros.
+#ifdef MIDEA_HOST
+#include "host_port.h"
+#else
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace midea {
+namespace port {
+
+inline uint32_t millis() { return esphome::millis(); }
+inline uint32_t micros() { return esphome::micros(); }
+
+}  // namespace port
+}  // namespace midea
+}  // namespace esphome
+#endif
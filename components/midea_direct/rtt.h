@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+namespace midea {
+
+/// Smoothed round-trip time and its mean deviation, as in TCP (RFC 6298), in milliseconds.
+/// Kept in fixed point (SRTT scaled by 8, RTTVAR by 4) so an update is a few adds and shifts.
+/// A timeout doubles the timeout, which stays doubled until a sample from a request sent only
+/// once arrives (RFC 6298 5.5 and 5.7): a unit that became slower is then still measured.
+class RttEstimator {
+ public:
+  void sample(uint32_t rtt) {
+    this->backoff_ = 0;
+    if (!this->samples_) {
+      this->srtt8_ = rtt << 3;
+      this->rttvar4_ = rtt << 1;
+    } else {
+      int32_t err = static_cast<int32_t>(rtt) - static_cast<int32_t>(this->srtt8_ >> 3);
+      this->srtt8_ += err;
+      if (err < 0)
+        err = -err;
+      this->rttvar4_ += err - static_cast<int32_t>(this->rttvar4_ >> 2);
+    }
+    if (this->samples_ != UINT16_MAX)
+      ++this->samples_;
+  }
+  /// A response timed out
+  void backoff() {
+    if (this->backoff_ < MAX_BACKOFF)
+      ++this->backoff_;
+  }
+  uint16_t samples() const { return this->samples_; }
+  uint32_t srtt() const { return this->srtt8_ >> 3; }
+  uint32_t rttvar() const { return this->rttvar4_ >> 2; }
+  /// Times the timeout has been doubled since the last sample
+  uint8_t backoffs() const { return this->backoff_; }
+  /// SRTT + 4 * RTTVAR bounded to [minimum, maximum], doubled per backoff up to `maximum`;
+  /// `maximum` until the first sample
+  uint32_t timeout(uint32_t minimum, uint32_t maximum) const {
+    if (!this->samples_)
+      return maximum;
+    uint32_t timeout = this->srtt() + this->rttvar4_;
+    if (timeout < minimum)
+      timeout = minimum;
+    if (timeout > maximum >> this->backoff_)
+      return maximum;
+    return timeout << this->backoff_;
+  }
+
+ private:
+  // Doublings beyond this always reach any timeout limit in use
+  static constexpr uint8_t MAX_BACKOFF = 8;
+  uint32_t srtt8_{};
+  uint32_t rttvar4_{};
+  uint16_t samples_{};
+  uint8_t backoff_{};
+};
+
+}  // namespace midea
+}  // namespace esphome
@@ -4,7 +4,7 @@ namespace esphome {
 namespace midea {
 namespace ac {
 
-float StatusData::getTargetTemp() const {
+float StatusView::getTargetTemp() const {
   uint8_t tmp = this->getValue_(2, 15) + 16;
   uint8_t tmpNew = this->getValue_(13, 31);
   if (tmpNew)
@@ -33,11 +33,9 @@ static float getTemp(int integer, int decimal, bool fahrenheits) {
     return static_cast<float>(integer / 2) + ((integer >= 0) ? 0.5F : -0.5F);
   return static_cast<float>(integer) * 0.5F;
 }
-float StatusData::getIndoorTemp() const { return getTemp(this->getValue_(11), this->getValue_(15, 15), this->isFahrenheits()); }
-float StatusData::getOutdoorTemp() const { return getTemp(this->getValue_(12), this->getValue_(15, 15, 4), this->isFahrenheits()); }
-float StatusData::getHumiditySetpoint() const { return static_cast<float>(this->getValue_(19, 127)); }
-
-Mode StatusData::getMode() const { return this->getPower_() ? this->getRawMode() : Mode::MODE_OFF; }
+float StatusView::getIndoorTemp() const { return getTemp(this->getValue_(11), this->getValue_(15, 15), this->isFahrenheits()); }
+float StatusView::getOutdoorTemp() const { return getTemp(this->getValue_(12), this->getValue_(15, 15, 4), this->isFahrenheits()); }
+float StatusView::getHumiditySetpoint() const { return static_cast<float>(this->getValue_(19, 127)); }
 
 void StatusData::setMode(Mode mode) {
   if (mode != Mode::MODE_OFF) {
@@ -48,7 +46,7 @@ void StatusData::setMode(Mode mode) {
   }
 }
 
-FanMode StatusData::getFanMode() const {
+FanMode StatusView::getFanMode() const {
   //some ACs return 30 for LOW and 50 for MEDIUM. Note though, in appMode, this device still uses 40/60
   uint8_t fanMode = this->getValue_(3);
   if (fanMode == 30) {
@@ -59,7 +57,7 @@ FanMode StatusData::getFanMode() const {
   return static_cast<FanMode>(fanMode); 
 }
 
-Preset StatusData::getPreset() const {
+Preset StatusView::getPreset() const {
   if (this->getEco_())
     return Preset::PRESET_ECO;
   if (this->getTurbo_())
@@ -98,9 +96,9 @@ void StatusData::setPreset(Preset preset) {
 
 static uint8_t bcd2u8(uint8_t bcd) { return 10 * (bcd >> 4) + (bcd & 15); }
 
-float StatusData::getPowerUsage() const {
+float StatusView::getPowerUsage() const {
   uint32_t power = 0;
-  const uint8_t *ptr = this->data_.data() + 18;
+  const uint8_t *ptr = this->data_ + 18;
   for (uint32_t weight = 1;; weight *= 100, --ptr) {
     power += weight * bcd2u8(*ptr);
     if (weight == 10000)
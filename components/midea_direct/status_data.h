@@ -64,32 +64,23 @@ enum Preset : uint8_t {
   PRESET_AWAY,
 };
 
-class StatusData : public FrameData {
+/// Read-only status decoder working directly on received frame bytes
+class StatusView : public FrameView {
  public:
-  StatusData() : FrameData({0x40, 0x00, 0x00, 0x00, 0x7F, 0x7F, 0x00, 0x00, 0x00, 0x00,
-                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                            0x00, 0x00, 0x00, 0x00}) {}
-  StatusData(const FrameData &data) : FrameData(data) {}
-
-  /// Copy status from another StatusData
-  void copyStatus(const StatusData &p) { memcpy(this->data_.data() + 1, p.data() + 1, 10); }
+  StatusView(const FrameView &view) : FrameView(view) {}
 
   /* TARGET TEMPERATURE */
   float getTargetTemp() const;
-  void setTargetTemp(float temp);
 
   /* MODE */
   Mode getRawMode() const { return static_cast<Mode>(this->getValue_(2, 7, 5)); }
-  Mode getMode() const;
-  void setMode(Mode mode);
+  Mode getMode() const { return this->getPower_() ? this->getRawMode() : Mode::MODE_OFF; }
 
   /* FAN SPEED */
   FanMode getFanMode() const;
-  void setFanMode(FanMode mode) { this->setValue_(3, mode); };
 
   /* SWING MODE */
   SwingMode getSwingMode() const { return static_cast<SwingMode>(this->getValue_(7, 15)); }
-  void setSwingMode(SwingMode mode) { this->setValue_(7, 0x30 | mode); }
 
   /* INDOOR TEMPERATURE */
   float getIndoorTemp() const;
@@ -102,70 +93,122 @@ class StatusData : public FrameData {
 
   /* PRESET */
   Preset getPreset() const;
-  void setPreset(Preset preset);
 
   /* POWER USAGE */
   float getPowerUsage() const;
 
+  bool isFahrenheits() const { return this->getValue_(10, 4); }
+
+ protected:
+  /* POWER */
+  bool getPower_() const { return this->getValue_(1, 1); }
+  /* ECO MODE */
+  bool getEco_() const { return this->getValue_(9, 16); }
+  /* TURBO MODE */
+  bool getTurbo_() const { return this->getValue_(8, 32) || this->getValue_(10, 2); }
+  /* FREEZE PROTECTION */
+  bool getFreezeProtection_() const { return this->getValue_(21, 128); }
+  /* SLEEP MODE */
+  bool getSleep_() const { return this->getValue_(10, 1); }
+};
+
+class StatusData : public FrameData {
+ public:
+  StatusData() : FrameData({0x40, 0x00, 0x00, 0x00, 0x7F, 0x7F, 0x00, 0x00, 0x00, 0x00,
+                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                            0x00, 0x00, 0x00, 0x00}) {}
+  StatusData(const FrameData &data) : FrameData(data) {}
+
+  /// Copy status from received status bytes
+  void copyStatus(const StatusView &p) { this->copy_(1, p.data() + 1, 10); }
+
+  /* TARGET TEMPERATURE */
+  float getTargetTemp() const { return this->view_().getTargetTemp(); }
+  void setTargetTemp(float temp);
+
+  /* MODE */
+  Mode getRawMode() const { return this->view_().getRawMode(); }
+  Mode getMode() const { return this->view_().getMode(); }
+  void setMode(Mode mode);
+
+  /* FAN SPEED */
+  FanMode getFanMode() const { return this->view_().getFanMode(); }
+  void setFanMode(FanMode mode) { this->setValue_(3, mode); };
+
+  /* SWING MODE */
+  SwingMode getSwingMode() const { return this->view_().getSwingMode(); }
+  void setSwingMode(SwingMode mode) { this->setValue_(7, 0x30 | mode); }
+
+  /* PRESET */
+  Preset getPreset() const { return this->view_().getPreset(); }
+  void setPreset(Preset preset);
+
   void setBeeper(bool state) {
     this->setMask_(1, true, 2);
     this->setMask_(1, state, 64);
   }
 
-  bool isFahrenheits() const { return this->getValue_(10, 4); }
+  bool isFahrenheits() const { return this->view_().isFahrenheits(); }
   void setFahrenheits(bool state) { this->setMask_(10, state, 4); }
 
  protected:
+  StatusView view_() const { return StatusView(*this); }
   /* POWER */
-  bool getPower_() const { return this->getValue_(1, 1); }
   void setPower_(bool state) { this->setMask_(1, state, 1); }
   /* ECO MODE */
-  bool getEco_() const { return this->getValue_(9, 16); }
   void setEco_(bool state) { this->setMask_(9, state, 128); }
   /* TURBO MODE */
-  bool getTurbo_() const { return this->getValue_(8, 32) || this->getValue_(10, 2); }
   void setTurbo_(bool state) {
     this->setMask_(8, state, 32);
     this->setMask_(10, state, 2);
   }
   /* FREEZE PROTECTION */
-  bool getFreezeProtection_() const { return this->getValue_(21, 128); }
   void setFreezeProtection_(bool state) { this->setMask_(21, state, 128); }
   /* SLEEP MODE */
-  bool getSleep_() const { return this->getValue_(10, 1); }
   void setSleep_(bool state) { this->setMask_(10, state, 1); }
 };
 
 
+// Fixed request bodies, encoded with their CRC at compile time. A trailing 0x00 is the
+// placeholder for the per-send message ID (or random byte).
+static constexpr auto QUERY_STATE_TEMPLATE = makeFrameTemplate<22>({
+    0x41, 0x81, 0x00, 0xFF, 0x03, 0xFF, 0x00, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x00});
+static constexpr auto QUERY_POWER_TEMPLATE = makeFrameTemplate<23>({
+    0x41, 0x21, 0x01, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x04, 0x00});
+static constexpr auto DISPLAY_TOGGLE_TEMPLATE = makeFrameTemplate<22>({
+    0x41, 0x61, 0x00, 0xFF, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00});
+static constexpr auto GET_CAPABILITIES_TEMPLATE = makeFrameTemplate<3>({0xB5, 0x01, 0x11});
+static constexpr auto GET_CAPABILITIES_SECOND_TEMPLATE = makeFrameTemplate<4>({0xB5, 0x01, 0x01, 0x00});
+
 class QueryStateData : public FrameData {
  public:
-  QueryStateData() : FrameData({0x41, 0x81, 0x00, 0xFF, 0x03, 0xFF, 0x00, 0x02, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x03, FrameData::getID_()}) { this->appendCRC(); }
+  QueryStateData() : FrameData(QUERY_STATE_TEMPLATE, FrameData::getID_()) {}
 };
 
 class QueryPowerData : public FrameData {
  public:
-  QueryPowerData() : FrameData({0x41, 0x21, 0x01, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x04, FrameData::getID_()}) { this->appendCRC(); }
+  QueryPowerData() : FrameData(QUERY_POWER_TEMPLATE, FrameData::getID_()) {}
 };
 
 class DisplayToggleData : public FrameData {
  public:
-  DisplayToggleData() : FrameData({0x41, 0x61, 0x00, 0xFF, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00,
-                                   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                   0x00, FrameData::getRandom_()}) { this->appendCRC(); }
+  DisplayToggleData() : FrameData(DISPLAY_TOGGLE_TEMPLATE, FrameData::getRandom_()) {}
 };
 
 class GetCapabilitiesData : public FrameData {
  public:
-  GetCapabilitiesData() : FrameData({0xB5, 0x01, 0x11}) { this->appendCRC(); }
+  GetCapabilitiesData() : FrameData(GET_CAPABILITIES_TEMPLATE) {}
 };
 
 class GetCapabilitiesSecondData : public FrameData {
  public:
-  GetCapabilitiesSecondData() : FrameData({0xB5, 0x01, 0x01, 0x00}) { this->appendCRC(); }
+  GetCapabilitiesSecondData() : FrameData(GET_CAPABILITIES_SECOND_TEMPLATE) {}
 };
 
 }  // namespace ac
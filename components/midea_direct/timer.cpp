@@ -5,13 +5,122 @@ namespace midea {
 
 // Dummy function for incorrect using case.
 static void dummy(Timer *timer) { timer->stop(); }
-Timer::Timer() : callback_(dummy), alarm_(0) {}
+Timer::Timer() : clock_(&SystemClock::instance()), callback_(dummy), alarm_(0) {}
+
+Timer::~Timer() {
+  if (this->manager_ != nullptr)
+    this->manager_->unregisterTimer(*this);
+}
+
+void Timer::arm_(TimerTick ms, bool periodic) {
+  this->alarm_ = ms;
+  this->periodic_ = periodic;
+  this->reset();
+}
+
+void Timer::stop() {
+  this->alarm_ = 0;
+  if (this->manager_ != nullptr)
+    this->manager_->unlink_(this);
+}
+
+void Timer::reset() {
+  this->deadline_ = this->clock_->millis() + this->alarm_;
+  if (this->manager_ != nullptr && this->alarm_)
+    this->manager_->schedule_(this);
+}
+
+TimerManager::~TimerManager() {
+  for (Timer *timer = this->timers_; timer != nullptr; timer = timer->nextRegistered_) {
+    timer->manager_ = nullptr;
+    timer->next_ = nullptr;
+  }
+}
+
+void TimerManager::setClock(const Clock *clock) {
+  this->clock_ = clock;
+  for (Timer *timer = this->timers_; timer != nullptr; timer = timer->nextRegistered_)
+    timer->clock_ = clock;
+}
+
+void TimerManager::registerTimer(Timer &timer) {
+  if (timer.manager_ == this)
+    return;
+  if (timer.manager_ != nullptr)
+    timer.manager_->unregisterTimer(timer);
+  timer.manager_ = this;
+  timer.clock_ = this->clock_;
+  timer.nextRegistered_ = this->timers_;
+  this->timers_ = &timer;
+  ++this->count_;
+  if (timer.alarm_)
+    this->schedule_(&timer);
+}
+
+void TimerManager::unregisterTimer(Timer &timer) {
+  if (timer.manager_ != this)
+    return;
+  timer.stop();
+  for (Timer **it = &this->timers_; *it != nullptr; it = &(*it)->nextRegistered_) {
+    if (*it == &timer) {
+      *it = timer.nextRegistered_;
+      break;
+    }
+  }
+  timer.nextRegistered_ = nullptr;
+  timer.manager_ = nullptr;
+  --this->count_;
+}
+
+void TimerManager::startOnce(Timer &timer, TimerTick ms, TimerCallback cb) {
+  this->registerTimer(timer);
+  timer.setCallback(std::move(cb));
+  timer.start(ms);
+}
+
+void TimerManager::unlink_(Timer *timer) {
+  for (Timer **it = &this->head_; *it != nullptr; it = &(*it)->next_) {
+    if (*it == timer) {
+      *it = timer->next_;
+      timer->next_ = nullptr;
+      return;
+    }
+  }
+}
+
+void TimerManager::schedule_(Timer *timer) {
+  this->unlink_(timer);
+  // Deadlines are compared relative to each other, so the order survives tick wrap-around
+  Timer **it = &this->head_;
+  while (*it != nullptr && static_cast<int32_t>((*it)->deadline_ - timer->deadline_) <= 0)
+    it = &(*it)->next_;
+  timer->next_ = *it;
+  *it = timer;
+}
+
+bool TimerManager::isDue() const {
+  return this->head_ != nullptr && this->head_->isExpired();
+}
+
+TimerTick TimerManager::nextDeadline() const {
+  if (this->head_ == nullptr)
+    return UINT32_MAX;
+  const int32_t remaining = static_cast<int32_t>(this->head_->deadline_ - this->ms());
+  return remaining > 0 ? remaining : 0;
+}
 
-/// Timers task. Must be periodically called in loop function.
 void TimerManager::task() {
-  for (auto timer : timers_)
-    if (timer->isEnabled() && timer->isExpired())
-      timer->call();
+  while (this->isDue()) {
+    Timer *timer = this->head_;
+    this->head_ = timer->next_;
+    timer->next_ = nullptr;
+    if (timer->periodic_)
+      timer->reset();
+    else
+      timer->alarm_ = 0;
+    // The callback may re-arm, stop or re-time any timer, including this one
+    timer->call();
+  }
 }
 
 }  // namespace midea
@@ -1,47 +1,94 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
-#include <functional>
-#include <list>
-#include "esphome/core/hal.h"
+#include "clock.h"
+#include "delegate.h"
 
 namespace esphome {
 namespace midea {
 
 class Timer;
 using TimerTick = uint32_t;
-using TimerCallback = std::function<void(Timer *)>;
-using Timers = std::list<Timer *>;
+using TimerCallback = Delegate<void(Timer *)>;
 
+/// Runs due timers. Armed timers are kept in a list sorted by deadline, so task() and
+/// isDue() only look at its head; arming, stopping and expiring re-sort a single entry.
+/// Timers and the manager detach from each other when either is destroyed.
 class TimerManager {
   public:
-  static TimerTick ms() { return esphome::millis(); }
-  void registerTimer(Timer &timer) { timers_.push_back(&timer); }
+  TimerManager() = default;
+  TimerManager(const TimerManager &) = delete;
+  TimerManager &operator=(const TimerManager &) = delete;
+  ~TimerManager();
+  TimerTick ms() const { return this->clock_->millis(); }
+  /// Set time source of this manager and its timers
+  void setClock(const Clock *clock);
+  /// Attach a timer to this manager (idempotent)
+  void registerTimer(Timer &timer);
+  /// Detach a timer, stopping it
+  void unregisterTimer(Timer &timer);
+  /// Register `timer` if needed and fire `cb` once after `ms` (for transient delays)
+  void startOnce(Timer &timer, TimerTick ms, TimerCallback cb);
+  /// Number of registered timers
+  size_t size() const { return this->count_; }
+  /// Timers task. Must be periodically called in loop function.
   void task();
+  /// Whether a timer is due now
+  bool isDue() const;
+  /// Milliseconds until the earliest deadline (0 if due, UINT32_MAX if no timer is armed)
+  TimerTick nextDeadline() const;
 
   private:
-  Timers timers_;
+  friend class Timer;
+  void schedule_(Timer *timer);
+  void unlink_(Timer *timer);
+  // Armed timers, earliest deadline first
+  Timer *head_{nullptr};
+  // All registered timers
+  Timer *timers_{nullptr};
+  size_t count_{};
+  const Clock *clock_{&SystemClock::instance()};
 };
 
+/// Timer with a callback. One-shot timers disarm before their callback runs; periodic ones
+/// re-arm for the next period from the time they fire.
 class Timer {
   public:
   Timer();
-  bool isExpired() const { return TimerManager::ms() - this->last_ >= this->alarm_; }
+  Timer(const Timer &) = delete;
+  Timer &operator=(const Timer &) = delete;
+  /// Unregisters from its manager
+  ~Timer();
+  bool isExpired() const { return static_cast<int32_t>(this->clock_->millis() - this->deadline_) >= 0; }
   bool isEnabled() const { return this->alarm_; }
-  void start(TimerTick ms) {
-    this->alarm_ = ms;
-    this->reset();
-  }
-  void stop() { this->alarm_ = 0; }
-  void reset() { this->last_ = TimerManager::ms(); }
+  bool isPeriodic() const { return this->periodic_; }
+  /// Fire once after `ms`
+  void start(TimerTick ms) { this->arm_(ms, false); }
+  /// Fire every `ms`
+  void startPeriodic(TimerTick ms) { this->arm_(ms, true); }
+  void stop();
+  /// Restart the current period from now
+  void reset();
   void setCallback(TimerCallback cb) { this->callback_ = cb; }
   void call() { this->callback_(this); }
   private:
+  friend class TimerManager;
+  void arm_(TimerTick ms, bool periodic);
+  // Time source, set by the manager on registration
+  const Clock *clock_;
+  // Owning manager (nullptr until registered)
+  TimerManager *manager_{nullptr};
+  // Next armed timer of the manager
+  Timer *next_{nullptr};
+  // Next registered timer of the manager
+  Timer *nextRegistered_{nullptr};
   // Callback function or lambda
   TimerCallback callback_;
-  // Period of operation
+  // Period of operation (0 when stopped)
   TimerTick alarm_;
-  // Last time of operation
-  TimerTick last_;
+  // Time of the next expiry
+  TimerTick deadline_{};
+  bool periodic_{};
 };
 
 }  // namespace midea
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace midea {
+
+/// Byte stream to the appliance: ESPHome UART on the device, serial port or pty on a host.
+class Transport {
+ public:
+  virtual ~Transport() = default;
+  /// Number of bytes that can be read without blocking
+  virtual size_t available() = 0;
+  /// Read up to `size` bytes, returns the number of bytes read
+  virtual size_t read(uint8_t *data, size_t size) = 0;
+  /// Write all bytes
+  virtual void write(const uint8_t *data, size_t size) = 0;
+};
+
+}  // namespace midea
+}  // namespace esphome
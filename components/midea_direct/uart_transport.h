@@ -0,0 +1,20 @@
+#pragma once
+#include "esphome/components/uart/uart.h"
+#include "transport.h"
+
+namespace esphome {
+namespace midea {
+
+/// Transport over an ESPHome UART device
+class UARTTransport : public Transport {
+ public:
+  UARTTransport(uart::UARTDevice *uart_device) : uart_device_(uart_device) {}
+  size_t available() override { return this->uart_device_->available(); }
+  size_t read(uint8_t *data, size_t size) override { return this->uart_device_->read_array(data, size) ? size : 0; }
+  void write(const uint8_t *data, size_t size) override { this->uart_device_->write_array(data, size); }
+ private:
+  uart::UARTDevice *uart_device_;
+};
+
+}  // namespace midea
+}  // namespace esphome
@@ -0,0 +1,84 @@
+#include "capture_file.h"
+#include <cstring>
+
+namespace esphome {
+namespace midea {
+
+bool CaptureFileWriter::open(const char *path) {
+  this->close();
+  this->file_ = fopen(path, "wb");
+  this->started_ = false;
+  return this->file_ != nullptr;
+}
+
+void CaptureFileWriter::close() {
+  if (this->file_ != nullptr)
+    fclose(this->file_);
+  this->file_ = nullptr;
+}
+
+void CaptureFileWriter::record(CaptureDirection direction, const uint8_t *data, uint16_t size, uint32_t timestamp) {
+  if (this->file_ == nullptr || !size)
+    return;
+  if (!this->started_) {
+    uint8_t header[capture::HEADER_SIZE];
+    capture::writeHeader(header, timestamp);
+    fwrite(header, sizeof(header), 1, this->file_);
+    this->last_ = timestamp;
+    this->started_ = true;
+  }
+  uint8_t header[capture::MAX_RECORD_HEADER];
+  fwrite(header, capture::writeRecordHeader(header, direction, timestamp - this->last_, size), 1, this->file_);
+  fwrite(data, size, 1, this->file_);
+  // Sessions usually end with Ctrl-C
+  fflush(this->file_);
+  this->last_ = timestamp;
+}
+
+static int fromHex(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+bool loadCapture(const char *path, std::vector<uint8_t> &capture) {
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr)
+    return false;
+  capture.clear();
+  uint8_t buf[4096];
+  size_t size;
+  while ((size = fread(buf, 1, sizeof(buf), file)) > 0)
+    capture.insert(capture.end(), buf, buf + size);
+  fclose(file);
+  if (capture.size() >= sizeof(capture::MAGIC) && !memcmp(capture.data(), capture::MAGIC, sizeof(capture::MAGIC)))
+    return true;
+
+  // Device log: collect the hex payload of every "CAPTURE <offset>: <hex>" line
+  const std::string text(capture.begin(), capture.end());
+  capture.clear();
+  size_t pos = 0;
+  while ((pos = text.find("CAPTURE ", pos)) != std::string::npos) {
+    pos += 8;
+    const size_t colon = text.find(": ", pos);
+    const size_t eol = text.find('\n', pos);
+    if (colon == std::string::npos || colon > eol)
+      continue;
+    for (size_t i = colon + 2; i + 1 < text.size(); i += 2) {
+      const int hi = fromHex(text[i]);
+      const int lo = fromHex(text[i + 1]);
+      if (hi < 0 || lo < 0)
+        break;
+      capture.push_back((hi << 4) | lo);
+    }
+  }
+  return capture.size() >= capture::HEADER_SIZE &&
+         !memcmp(capture.data(), capture::MAGIC, sizeof(capture::MAGIC));
+}
+
+}  // namespace midea
+}  // namespace esphome
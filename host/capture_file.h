@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "capture.h"
+
+namespace esphome {
+namespace midea {
+
+/// Streams captured frames to a file in the capture format
+class CaptureFileWriter : public CaptureSink {
+ public:
+  ~CaptureFileWriter() override { this->close(); }
+  bool open(const char *path);
+  void close();
+  void record(CaptureDirection direction, const uint8_t *data, uint16_t size, uint32_t timestamp) override;
+ private:
+  FILE *file_{nullptr};
+  bool started_{};
+  uint32_t last_{};
+};
+
+/// Load a capture from a binary file or from a device log containing `dump_capture()` output
+bool loadCapture(const char *path, std::vector<uint8_t> &capture);
+
+}  // namespace midea
+}  // namespace esphome
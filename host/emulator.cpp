@@ -0,0 +1,233 @@
+#include "emulator.h"
+#include <algorithm>
+#include "frame_data.h"
+#include "port.h"
+
+namespace esphome {
+namespace midea {
+
+static constexpr uint8_t START_BYTE = 0xAA;
+static constexpr uint8_t OFFSET_PROTOCOL = 8;
+static constexpr uint8_t OFFSET_TYPE = 9;
+static constexpr uint8_t OFFSET_DATA = 10;
+static constexpr uint8_t APPLIANCE_AC = 0xAC;
+
+static uint8_t toBCD(uint32_t value) { return ((value / 10) << 4) | (value % 10); }
+static uint8_t encodeTemp(float temp) { return static_cast<uint8_t>(temp * 2.0F + 50.0F); }
+
+ApplianceEmulator::ApplianceEmulator(const EmulatorConfig &config, const Clock *clock)
+    : config_(config), clock_(clock), rng_(config.seed) {}
+
+uint32_t ApplianceEmulator::now_() const { return this->clock_->millis(); }
+
+size_t ApplianceEmulator::available() {
+  this->poll_();
+  const uint32_t now = this->now_();
+  size_t count = 0;
+  for (const auto &pending : this->tx_) {
+    if (static_cast<int32_t>(now - pending.due) < 0)
+      break;
+    ++count;
+  }
+  return count;
+}
+
+size_t ApplianceEmulator::read(uint8_t *data, size_t size) {
+  size = std::min(size, this->available());
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = this->tx_.front().data;
+    this->tx_.pop_front();
+  }
+  return size;
+}
+
+void ApplianceEmulator::write(const uint8_t *data, size_t size) {
+  this->rx_.insert(this->rx_.end(), data, data + size);
+  for (;;) {
+    auto start = std::find(this->rx_.begin(), this->rx_.end(), START_BYTE);
+    this->rx_.erase(this->rx_.begin(), start);
+    if (this->rx_.size() < 2)
+      return;
+    const uint8_t length = this->rx_[1];
+    if (length <= OFFSET_DATA) {
+      this->rx_.erase(this->rx_.begin());
+      continue;
+    }
+    if (this->rx_.size() < length + 1u)
+      return;
+    uint8_t cs = 0;
+    for (unsigned i = 1; i <= length; ++i)
+      cs += this->rx_[i];
+    if (cs) {
+      ++this->stats_.framesRejected;
+      this->rx_.erase(this->rx_.begin());
+      continue;
+    }
+    ++this->stats_.framesReceived;
+    this->protocol_ = this->rx_[OFFSET_PROTOCOL];
+    this->handleFrame_(this->rx_[OFFSET_TYPE], this->rx_.data() + OFFSET_DATA, length - OFFSET_DATA);
+    this->rx_.erase(this->rx_.begin(), this->rx_.begin() + length + 1);
+  }
+}
+
+void ApplianceEmulator::poll_() {
+  const uint32_t now = this->now_();
+  if (this->config_.queryNetworkInterval && now - this->lastQueryNetwork_ >= this->config_.queryNetworkInterval) {
+    this->lastQueryNetwork_ = now;
+    this->send_(0x63, {0x01}, 0);
+  }
+}
+
+void ApplianceEmulator::handleFrame_(uint8_t type, const uint8_t *body, uint8_t size) {
+  switch (type) {
+    case 0x02:
+      if (body[0] != 0x40)
+        return;
+      ++this->stats_.controls;
+      this->applyControl_(body, size);
+      this->respond_(type, body, size);
+      return;
+    case 0x03:
+      if (body[0] == 0x41 && size > 1) {
+        if (body[1] == 0x21)
+          ++this->stats_.powerQueries;
+        else
+          ++this->stats_.statusQueries;
+      } else if (body[0] == 0xB5) {
+        ++this->stats_.capabilityQueries;
+      }
+      this->respond_(type, body, size);
+      return;
+    case 0x0D:
+      ++this->stats_.networkNotifies;
+      return;
+    case 0x63:
+      ++this->stats_.networkQueries;
+      return;
+  }
+}
+
+void ApplianceEmulator::respond_(uint8_t type, const uint8_t *body, uint8_t size) {
+  if (this->isSilent_()) {
+    ++this->stats_.responsesSilenced;
+    return;
+  }
+  uint32_t delay = this->config_.latency;
+  if (this->config_.jitter)
+    delay += this->rng_() % (this->config_.jitter + 1);
+  if (body[0] == 0xB5)
+    this->send_(type, this->capabilitiesBody_(size > 3 && body[2] == 0x01), delay);
+  else if (body[0] == 0x41 && size > 1 && body[1] == 0x21)
+    this->send_(type, this->powerBody_(), delay);
+  else
+    this->send_(type, this->statusBody_(), delay);
+}
+
+void ApplianceEmulator::applyControl_(const uint8_t *b, uint8_t size) {
+  if (size < 22)
+    return;
+  auto &s = this->state_;
+  s.power = b[1] & 1;
+  s.mode = (b[2] >> 5) & 7;
+  s.target = static_cast<float>((b[2] & 15) + 16) + ((b[2] & 16) ? 0.5F : 0.0F);
+  s.fan = b[3];
+  s.swing = b[7] & 15;
+  s.turbo = (b[8] & 32) || (b[10] & 2);
+  s.eco = b[9] & 128;
+  s.sleep = b[10] & 1;
+  s.freeze = b[21] & 128;
+  s.powerUsage = s.power ? 450.0F + 5.0F * std::min<uint8_t>(s.fan, 100) : 0.0F;
+}
+
+std::vector<uint8_t> ApplianceEmulator::statusBody_() const {
+  const auto &s = this->state_;
+  std::vector<uint8_t> b(24, 0);
+  const uint8_t integer = static_cast<uint8_t>(s.target);
+  b[0] = 0xC0;
+  b[1] = s.power ? 1 : 0;
+  b[2] = (s.mode << 5) | ((integer - 16) & 15) | ((s.target - integer) >= 0.5F ? 16 : 0);
+  b[3] = s.fan;
+  b[7] = s.swing;
+  b[8] = s.turbo ? 32 : 0;
+  b[9] = s.eco ? 16 : 0;
+  b[10] = (s.sleep ? 1 : 0) | (s.turbo ? 2 : 0);
+  b[11] = encodeTemp(s.indoor);
+  b[12] = encodeTemp(s.outdoor);
+  b[19] = s.humidity & 127;
+  b[21] = s.freeze ? 128 : 0;
+  return b;
+}
+
+std::vector<uint8_t> ApplianceEmulator::powerBody_() const {
+  std::vector<uint8_t> b(20, 0);
+  const uint32_t value = static_cast<uint32_t>(this->state_.powerUsage * 10.0F);
+  b[0] = 0xC1;
+  b[1] = 0x21;
+  b[2] = 0x01;
+  b[3] = 0x44;
+  b[16] = toBCD(value / 10000 % 100);
+  b[17] = toBCD(value / 100 % 100);
+  b[18] = toBCD(value % 100);
+  return b;
+}
+
+std::vector<uint8_t> ApplianceEmulator::capabilitiesBody_(bool second) const {
+  if (second) {
+    return {0xB5, 3,
+            0x16, 0x02, 1, static_cast<uint8_t>(this->config_.powerMeter ? 2 : 0),  // power
+            0x24, 0x02, 1, 1,                                                     // light control
+            0x2C, 0x02, 1, 1};                                                    // buzzer
+  }
+  return {0xB5, 5,
+          0x14, 0x02, 1, 1,                         // modes: cool, heat, dry, auto
+          0x15, 0x02, 1, 1,                         // swing: both
+          0x12, 0x02, 1, 1,                         // eco
+          0x1A, 0x02, 1, 1,                         // turbo cool and heat
+          0x25, 0x02, 6, 34, 60, 34, 60, 34, 60,    // temperatures 17..30
+          0x01, 0x00};                              // more pages follow
+}
+
+void ApplianceEmulator::send_(uint8_t type, std::vector<uint8_t> body, uint32_t delay) {
+  body.push_back(crc8(body.data(), body.size()));
+  const uint8_t length = OFFSET_DATA + body.size();
+  std::vector<uint8_t> frame = {START_BYTE, length, APPLIANCE_AC, static_cast<uint8_t>(length ^ APPLIANCE_AC),
+                                0, 0, 0, 0, this->protocol_, type};
+  frame.insert(frame.end(), body.begin(), body.end());
+  uint8_t cs = 0;
+  for (size_t i = 1; i < frame.size(); ++i)
+    cs -= frame[i];
+  frame.push_back(cs);
+  ++this->stats_.responsesSent;
+
+  // Bytes leave one character time (~1 ms at 9600 baud) apart, after any pending output
+  uint32_t due = this->now_() + delay;
+  if (!this->tx_.empty() && static_cast<int32_t>(this->tx_.back().due - due) > 0)
+    due = this->tx_.back().due;
+  for (size_t i = 0; i < frame.size(); ++i) {
+    if (this->chance_(this->config_.byteLoss)) {
+      ++this->stats_.bytesLost;
+      continue;
+    }
+    uint8_t data = frame[i];
+    if (this->chance_(this->config_.bitFlip)) {
+      ++this->stats_.bitsFlipped;
+      data ^= 1 << (this->rng_() % 8);
+    }
+    this->tx_.push_back({due + static_cast<uint32_t>(i * 1042 / 1000), data});
+  }
+}
+
+bool ApplianceEmulator::isSilent_() {
+  if (this->chance_(this->config_.silence))
+    return true;
+  return this->config_.silentEvery && this->now_() % this->config_.silentEvery < this->config_.silentFor;
+}
+
+bool ApplianceEmulator::chance_(float probability) {
+  if (probability <= 0.0F)
+    return false;
+  return std::uniform_real_distribution<float>(0.0F, 1.0F)(this->rng_) < probability;
+}
+
+}  // namespace midea
+}  // namespace esphome
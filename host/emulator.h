@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+#include "clock.h"
+#include "transport.h"
+
+namespace esphome {
+namespace midea {
+
+/// Fault and timing model of the emulated appliance
+struct EmulatorConfig {
+  // Response delay: latency plus uniform jitter in [0, jitter]
+  uint32_t latency{80};
+  uint32_t jitter{40};
+  // Probability of dropping a transmitted byte
+  float byteLoss{0.0F};
+  // Probability of flipping one bit of a transmitted byte
+  float bitFlip{0.0F};
+  // Probability of ignoring a request completely
+  float silence{0.0F};
+  // Periodic silent window: for `silentFor` ms out of every `silentEvery` ms (0 disables)
+  uint32_t silentEvery{0};
+  uint32_t silentFor{0};
+  // Interval of unsolicited QUERY_NETWORK(0x63) requests (0 disables)
+  uint32_t queryNetworkInterval{0};
+  // Advertised capabilities: power metering and two-page B5 report
+  bool powerMeter{true};
+  uint32_t seed{1};
+};
+
+/// Emulator counters, for comparing runs
+struct EmulatorStats {
+  uint32_t framesReceived{};
+  uint32_t framesRejected{};
+  uint32_t statusQueries{};
+  uint32_t powerQueries{};
+  uint32_t controls{};
+  uint32_t capabilityQueries{};
+  uint32_t networkNotifies{};
+  uint32_t networkQueries{};
+  uint32_t responsesSent{};
+  uint32_t responsesSilenced{};
+  uint32_t bytesLost{};
+  uint32_t bitsFlipped{};
+};
+
+/// Emulated Midea air conditioner, speaking the UART protocol of the component.
+///
+/// It is the engine's Transport: bytes written by ApplianceBase are parsed as requests,
+/// responses become readable once their delivery time has passed. State is kept in the
+/// same encoding StatusData uses, so the engine decodes it like a real unit.
+class ApplianceEmulator : public Transport {
+ public:
+  explicit ApplianceEmulator(const EmulatorConfig &config = {}, const Clock *clock = &SystemClock::instance());
+
+  /* Transport */
+  size_t available() override;
+  size_t read(uint8_t *data, size_t size) override;
+  void write(const uint8_t *data, size_t size) override;
+
+  /// Emulated state
+  struct State {
+    bool power{false};
+    uint8_t mode{2};  // COOL
+    uint8_t fan{102};  // AUTO
+    uint8_t swing{0};
+    float target{24.0F};
+    float indoor{26.0F};
+    float outdoor{31.0F};
+    uint8_t humidity{45};
+    bool eco{false};
+    bool turbo{false};
+    bool sleep{false};
+    bool freeze{false};
+    float powerUsage{0.0F};
+  };
+  State &state() { return this->state_; }
+  const EmulatorStats &stats() const { return this->stats_; }
+  EmulatorConfig &config() { return this->config_; }
+
+ protected:
+  struct Pending {
+    uint32_t due;
+    uint8_t data;
+  };
+  uint32_t now_() const;
+  void poll_();
+  void handleFrame_(uint8_t type, const uint8_t *body, uint8_t size);
+  void applyControl_(const uint8_t *body, uint8_t size);
+  void respond_(uint8_t type, const uint8_t *body, uint8_t size);
+  void send_(uint8_t type, std::vector<uint8_t> body, uint32_t delay);
+  std::vector<uint8_t> statusBody_() const;
+  std::vector<uint8_t> powerBody_() const;
+  std::vector<uint8_t> capabilitiesBody_(bool second) const;
+  bool isSilent_();
+  bool chance_(float probability);
+
+  EmulatorConfig config_;
+  const Clock *clock_;
+  EmulatorStats stats_{};
+  State state_{};
+  std::mt19937 rng_;
+  // Bytes from the engine not yet forming a complete frame
+  std::vector<uint8_t> rx_;
+  // Bytes to the engine, with delivery time
+  std::deque<Pending> tx_;
+  uint32_t lastQueryNetwork_{};
+  uint8_t protocol_{};
+};
+
+}  // namespace midea
+}  // namespace esphome
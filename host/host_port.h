@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+// Host implementation of the platform seam (see components/midea_direct/port.h)
+
+namespace esphome {
+namespace midea {
+namespace port {
+
+enum LogLevel : uint8_t {
+  LOG_LEVEL_NONE,
+  LOG_LEVEL_ERROR,
+  LOG_LEVEL_WARN,
+  LOG_LEVEL_INFO,
+  LOG_LEVEL_CONFIG,
+  LOG_LEVEL_DEBUG,
+  LOG_LEVEL_VERBOSE,
+};
+
+/// Milliseconds since start
+uint32_t millis();
+/// Microseconds since start
+uint32_t micros();
+
+void setLogLevel(LogLevel level);
+LogLevel getLogLevel();
+void log(LogLevel level, const char *tag, const char *format, ...);
+
+}  // namespace port
+}  // namespace midea
+}  // namespace esphome
+
+#define MIDEA_HOST_LOG(level, tag, ...) \
+  do { \
+    if (::esphome::midea::port::getLogLevel() >= (level)) \
+      ::esphome::midea::port::log((level), (tag), __VA_ARGS__); \
+  } while (0)
+
+#define ESP_LOGE(tag, ...) MIDEA_HOST_LOG(::esphome::midea::port::LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) MIDEA_HOST_LOG(::esphome::midea::port::LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) MIDEA_HOST_LOG(::esphome::midea::port::LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) MIDEA_HOST_LOG(::esphome::midea::port::LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) MIDEA_HOST_LOG(::esphome::midea::port::LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) MIDEA_HOST_LOG(::esphome::midea::port::LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
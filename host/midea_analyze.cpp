@@ -0,0 +1,470 @@
+// Offline analysis of UART session captures, split across all cores.
+//
+//   midea_analyze [-j threads] [-t timeline.csv] <capture>...
+//
+// Every capture is memory-mapped and indexed, then cut into chunks of records that worker
+// threads decode with the engine's own decoders (Frame, StatusView, Capabilities). Reports
+// request->response latency percentiles per request kind, retry and timeout rates, checksum
+// and CRC failure rates (from the frames the receiver rejected), flushed partial frames, and
+// optionally writes the state-change timeline of every capture.
+//
+// A request is a TX frame; it is answered by the next RX frame of the same frame type (as
+// the engine matches responses). A TX sent while a request is unanswered marks a timeout of
+// that request, and a retry if it repeats the same request kind.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "appliance_base.h"
+#include "capabilities.h"
+#include "capture_file.h"
+#include "frame.h"
+#include "status_data.h"
+
+using namespace esphome::midea;
+
+// Records per work item: large enough to amortize scheduling, small enough to balance load
+static const size_t CHUNK_RECORDS = 1 << 16;
+// Latency histogram: 100 µs bins up to 5 s, the last bin collects everything slower
+static const uint32_t BIN_US = 100;
+static const size_t BINS = 50000;
+
+/// Capture mapped into memory (or loaded, for device logs)
+struct Input {
+  std::string path;
+  const uint8_t *data{nullptr};
+  size_t size{};
+  void *map{nullptr};
+  std::vector<uint8_t> loaded;
+  uint64_t origin{};
+  uint64_t records{};
+  bool valid{};
+};
+
+/// Slice of a capture decoded by one worker
+struct WorkItem {
+  size_t input;
+  CaptureReader::Position begin;
+  uint64_t count;
+  bool first;
+};
+
+/// Decoded climate state, compared to detect changes
+struct State {
+  uint8_t mode, preset, fan, swing;
+  float target;
+  bool operator!=(const State &other) const {
+    return this->mode != other.mode || this->preset != other.preset || this->fan != other.fan ||
+           this->swing != other.swing || this->target != other.target;
+  }
+};
+
+struct Change {
+  uint64_t timestamp;
+  State state;
+};
+
+/// Timeline fragment of one work item. The first state of the slice is kept apart: whether it is
+/// a change depends on the last state of the previous slice, known only when merging.
+struct Timeline {
+  bool hasState{};
+  Change first;
+  State last;
+  std::vector<Change> changes;
+};
+
+struct KindStats {
+  uint64_t requests{};
+  uint64_t responses{};
+  uint64_t retries{};
+  uint64_t timeouts{};
+  uint64_t maxLatency{};
+  std::vector<uint32_t> histogram = std::vector<uint32_t>(BINS);
+  void merge(const KindStats &other) {
+    this->requests += other.requests;
+    this->responses += other.responses;
+    this->retries += other.retries;
+    this->timeouts += other.timeouts;
+    this->maxLatency = std::max(this->maxLatency, other.maxLatency);
+    for (size_t i = 0; i < BINS; ++i)
+      this->histogram[i] += other.histogram[i];
+  }
+  double percentile(double p) const {
+    const uint64_t rank = static_cast<uint64_t>(p * this->responses);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BINS; ++i) {
+      seen += this->histogram[i];
+      if (seen > rank)
+        return std::min<uint64_t>((i + 1) * BIN_US, this->maxLatency) / 1000.0;
+    }
+    return this->maxLatency / 1000.0;
+  }
+};
+
+struct Stats {
+  uint64_t tx{};
+  uint64_t rx{};
+  uint64_t checksumErrors{};
+  uint64_t crcErrors{};
+  uint64_t flushed{};
+  uint64_t unsolicited{};
+  uint64_t status{};
+  uint64_t capabilityPages{};
+  uint64_t truncated{};
+  std::map<uint32_t, KindStats> kinds;
+  void merge(const Stats &other) {
+    this->tx += other.tx;
+    this->rx += other.rx;
+    this->checksumErrors += other.checksumErrors;
+    this->crcErrors += other.crcErrors;
+    this->flushed += other.flushed;
+    this->unsolicited += other.unsolicited;
+    this->status += other.status;
+    this->capabilityPages += other.capabilityPages;
+    this->truncated += other.truncated;
+    for (const auto &kind : other.kinds)
+      this->kinds[kind.first].merge(kind.second);
+  }
+};
+
+static bool mapInput(Input &input) {
+  const int fd = open(input.path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(capture::HEADER_SIZE)) {
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+      madvise(map, st.st_size, MADV_SEQUENTIAL);
+      input.map = map;
+      input.data = static_cast<const uint8_t *>(map);
+      input.size = st.st_size;
+    }
+  }
+  close(fd);
+  if (input.data != nullptr && !memcmp(input.data, capture::MAGIC, sizeof(capture::MAGIC)))
+    return true;
+  // Not a binary capture: try a device log with dump_capture() output
+  if (input.map != nullptr)
+    munmap(input.map, input.size);
+  input.map = nullptr;
+  if (!loadCapture(input.path.c_str(), input.loaded))
+    return false;
+  input.data = input.loaded.data();
+  input.size = input.loaded.size();
+  return true;
+}
+
+/// Record boundaries every CHUNK_RECORDS records: the varint time deltas make the format
+/// sequential, so each capture is walked once (headers only) before it can be split.
+static void indexInput(size_t index, Input &input, std::vector<WorkItem> &items) {
+  if (!mapInput(input))
+    return;
+  CaptureReader reader(input.data, input.size);
+  if (!reader.isValid())
+    return;
+  input.valid = true;
+  CaptureReader::Position position = reader.tell();
+  CaptureReader::Record record;
+  uint64_t count = 0;
+  while (reader.next(record)) {
+    if (!input.records)
+      input.origin = record.timestamp;
+    ++input.records;
+    if (++count == CHUNK_RECORDS) {
+      items.push_back({index, position, count, items.empty()});
+      position = reader.tell();
+      count = 0;
+    }
+  }
+  if (count)
+    items.push_back({index, position, count, items.empty()});
+}
+
+static uint32_t kindOf(const Frame &frame) {
+  const uint8_t *data = frame.data();
+  return static_cast<uint32_t>(data[9]) << 16 | (frame.size() > 10 ? data[10] << 8 : 0) |
+         (frame.size() > 11 ? data[11] : 0);
+}
+
+static const char *kindName(uint32_t kind) {
+  switch (kind) {
+    case 0x034181:
+      return "GET_STATUS";
+    case 0x034121:
+      return "GET_POWER";
+    case 0x034161:
+      return "DISPLAY_TOGGLE";
+    case 0x03B501:
+      return "GET_CAPABILITIES";
+    default:
+      break;
+  }
+  switch (kind >> 16) {
+    case DEVICE_CONTROL:
+      return "CONTROL";
+    case GET_ELECTRONIC_ID:
+      return "GET_ELECTRONIC_ID";
+    case NETWORK_NOTIFY:
+      return "NETWORK_NOTIFY";
+    default:
+      return "OTHER";
+  }
+}
+
+/// Request waiting for its response
+struct Pending {
+  bool active{};
+  uint8_t type;
+  uint32_t kind;
+  uint64_t timestamp;
+};
+
+/// Network notifications and replies to the appliance's network queries expect no response
+static bool isRequest(const Frame &frame) { return !frame.hasType(NETWORK_NOTIFY) && !frame.hasType(QUERY_NETWORK); }
+
+/// Start a request; an unanswered previous one timed out
+static void pairTx(Stats &stats, Pending &pending, const Frame &frame, uint64_t timestamp) {
+  if (!isRequest(frame))
+    return;
+  const uint32_t kind = kindOf(frame);
+  if (pending.active) {
+    KindStats &previous = stats.kinds[pending.kind];
+    ++previous.timeouts;
+    if (pending.kind == kind)
+      ++previous.retries;
+  }
+  ++stats.kinds[kind].requests;
+  pending = {true, frame.data()[9], kind, timestamp};
+}
+
+static void pairRx(Stats &stats, Pending &pending, const Frame &frame, uint64_t timestamp) {
+  // Acknowledges of our network notifications, ignored by the engine too
+  if (frame.hasType(NETWORK_NOTIFY))
+    return;
+  if (!pending.active || !frame.hasType(pending.type)) {
+    ++stats.unsolicited;
+    return;
+  }
+  KindStats &kind = stats.kinds[pending.kind];
+  const uint64_t latency = timestamp - pending.timestamp;
+  ++kind.responses;
+  ++kind.histogram[std::min<uint64_t>(latency / BIN_US, BINS - 1)];
+  kind.maxLatency = std::max(kind.maxLatency, latency);
+  pending.active = false;
+}
+
+static void decodeRx(Stats &stats, Timeline &timeline, ac::Capabilities &capabilities, const Frame &frame,
+                     uint64_t timestamp) {
+  if (!frame.isValid()) {
+    ++stats.checksumErrors;
+    return;
+  }
+  const FrameView body = frame.getData();
+  if (!body.size() || !body.hasValidCRC()) {
+    ++stats.crcErrors;
+    return;
+  }
+  if (body.hasStatus()) {
+    ++stats.status;
+    const ac::StatusView view(body);
+    const State state{static_cast<uint8_t>(view.getMode()), static_cast<uint8_t>(view.getPreset()),
+                      static_cast<uint8_t>(view.getFanMode()), static_cast<uint8_t>(view.getSwingMode()),
+                      view.getTargetTemp()};
+    if (!timeline.hasState) {
+      timeline.hasState = true;
+      timeline.first = {timestamp, state};
+    } else if (state != timeline.last) {
+      timeline.changes.push_back({timestamp, state});
+    }
+    timeline.last = state;
+  } else if (body.hasID(0xB5)) {
+    ++stats.capabilityPages;
+    capabilities.read(body);
+  }
+}
+
+static void analyze(const Input &input, const WorkItem &item, Stats &stats, Timeline &timeline) {
+  CaptureReader reader(input.data, input.size);
+  reader.seek(item.begin);
+  CaptureReader::Record record;
+  ac::Capabilities capabilities;
+  Pending pending;
+  // Leading RX frames belong to the previous slice's last request, which pairs them
+  bool paired = item.first;
+  for (uint64_t i = 0; i < item.count; ++i) {
+    if (!reader.next(record)) {
+      ++stats.truncated;
+      return;
+    }
+    const Frame frame(record.data, record.size);
+    if (record.direction == CAPTURE_TX) {
+      ++stats.tx;
+      paired = true;
+      pairTx(stats, pending, frame, record.timestamp);
+    } else if (record.direction == CAPTURE_RX_FLUSHED) {
+      ++stats.flushed;
+    } else {
+      // Rejected frames land in the checksum and CRC8 failure counts
+      ++stats.rx;
+      decodeRx(stats, timeline, capabilities, frame, record.timestamp);
+      if (paired && record.direction == CAPTURE_RX)
+        pairRx(stats, pending, frame, record.timestamp);
+    }
+  }
+  // Pair RX frames past the end of the slice up to the next request, which is only classified
+  // (timeout and retry of our last request) without being counted as sent.
+  while (reader.next(record)) {
+    const Frame frame(record.data, record.size);
+    if (record.direction == CAPTURE_RX) {
+      pairRx(stats, pending, frame, record.timestamp);
+    } else if (record.direction == CAPTURE_TX && isRequest(frame)) {
+      if (pending.active) {
+        KindStats &previous = stats.kinds[pending.kind];
+        ++previous.timeouts;
+        if (pending.kind == kindOf(frame))
+          ++previous.retries;
+      }
+      break;
+    }
+  }
+}
+
+static void writeTimeline(FILE *file, const Input &input, const std::vector<const Timeline *> &timelines,
+                          uint64_t &changes) {
+  bool hasState = false;
+  State last{};
+  auto emit = [&](const Change &change) {
+    fprintf(file, "%s,%.3f,%u,%u,%u,%u,%.1f\n", input.path.c_str(), (change.timestamp - input.origin) / 1e6,
+            change.state.mode, change.state.preset, change.state.fan, change.state.swing, change.state.target);
+  };
+  for (const Timeline *timeline : timelines) {
+    if (!timeline->hasState)
+      continue;
+    if (!hasState || timeline->first.state != last) {
+      if (file != nullptr)
+        emit(timeline->first);
+      changes += hasState;
+    }
+    for (const Change &change : timeline->changes) {
+      if (file != nullptr)
+        emit(change);
+      ++changes;
+    }
+    hasState = true;
+    last = timeline->last;
+  }
+}
+
+static void runParallel(unsigned threads, size_t count, const std::function<void(size_t, unsigned)> &work) {
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < threads; ++t)
+    pool.emplace_back([&, t]() {
+      for (size_t i; (i = next++) < count;)
+        work(i, t);
+    });
+  for (std::thread &thread : pool)
+    thread.join();
+}
+
+static double rate(uint64_t count, uint64_t total) { return total ? 100.0 * count / total : 0.0; }
+
+int main(int argc, char **argv) {
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  const char *timelinePath = nullptr;
+  std::vector<Input> inputs;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-j") && i + 1 < argc)
+      threads = std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+      timelinePath = argv[++i];
+    else
+      inputs.emplace_back().path = argv[i];
+  }
+  if (inputs.empty()) {
+    fprintf(stderr, "usage: %s [-j threads] [-t timeline.csv] <capture>...\n", argv[0]);
+    return 1;
+  }
+  const auto start = std::chrono::steady_clock::now();
+
+  // Index captures in parallel, then flatten their slices into one work list
+  std::vector<std::vector<WorkItem>> slices(inputs.size());
+  runParallel(threads, inputs.size(), [&](size_t i, unsigned) { indexInput(i, inputs[i], slices[i]); });
+  std::vector<WorkItem> items;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (!inputs[i].valid)
+      fprintf(stderr, "%s: not a capture\n", inputs[i].path.c_str());
+    items.insert(items.end(), slices[i].begin(), slices[i].end());
+  }
+
+  std::vector<Stats> workerStats(threads);
+  std::vector<Timeline> timelines(items.size());
+  runParallel(threads, items.size(), [&](size_t i, unsigned t) {
+    analyze(inputs[items[i].input], items[i], workerStats[t], timelines[i]);
+  });
+  Stats stats;
+  for (const Stats &worker : workerStats)
+    stats.merge(worker);
+
+  FILE *timelineFile = nullptr;
+  if (timelinePath != nullptr) {
+    timelineFile = fopen(timelinePath, "w");
+    if (timelineFile == nullptr) {
+      perror(timelinePath);
+      return 1;
+    }
+    fprintf(timelineFile, "capture,time_s,mode,preset,fan,swing,target\n");
+  }
+  // Slices of one capture are contiguous in `items`, in capture order
+  uint64_t changes = 0;
+  for (size_t i = 0; i < items.size();) {
+    std::vector<const Timeline *> fragments;
+    const size_t input = items[i].input;
+    for (; i < items.size() && items[i].input == input; ++i)
+      fragments.push_back(&timelines[i]);
+    writeTimeline(timelineFile, inputs[input], fragments, changes);
+  }
+  if (timelineFile != nullptr)
+    fclose(timelineFile);
+
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const uint64_t frames = stats.tx + stats.rx;
+  printf("%zu captures, %" PRIu64 " frames (%" PRIu64 " TX, %" PRIu64 " RX) in %.2f s, %.1f Mframes/s, %u threads\n",
+         inputs.size(), frames, stats.tx, stats.rx, elapsed, frames / elapsed / 1e6, threads);
+  printf("RX checksum failures %" PRIu64 " (%.3f%%), CRC8 failures %" PRIu64 " (%.3f%%), flushed partial frames %" PRIu64
+         ", unsolicited %" PRIu64 "\n",
+         stats.checksumErrors, rate(stats.checksumErrors, stats.rx), stats.crcErrors, rate(stats.crcErrors, stats.rx),
+         stats.flushed, stats.unsolicited);
+  printf("%" PRIu64 " status frames, %" PRIu64 " state changes, %" PRIu64 " capability pages\n", stats.status,
+         changes, stats.capabilityPages);
+  if (stats.truncated)
+    printf("%" PRIu64 " truncated slices\n", stats.truncated);
+  printf("\n%-18s %10s %8s %8s %9s %9s %9s %9s %9s\n", "request", "count", "retry%", "timeout%", "p50 ms",
+         "p90 ms", "p99 ms", "p99.9 ms", "max ms");
+  for (const auto &entry : stats.kinds) {
+    const KindStats &kind = entry.second;
+    char name[40];
+    snprintf(name, sizeof(name), "%s %06X", kindName(entry.first), entry.first);
+    printf("%-24s %10" PRIu64 " %8.3f %8.3f %9.1f %9.1f %9.1f %9.1f %9.1f\n", name, kind.requests,
+           rate(kind.retries, kind.requests), rate(kind.timeouts, kind.requests), kind.percentile(0.5),
+           kind.percentile(0.9), kind.percentile(0.99), kind.percentile(0.999), kind.maxLatency / 1000.0);
+  }
+  for (Input &input : inputs)
+    if (input.map != nullptr)
+      munmap(input.map, input.size);
+  return 0;
+}
@@ -0,0 +1,225 @@
+// Micro-benchmarks of the protocol core hot paths, in host CPU time.
+//
+//   midea_bench [n=1000000] [seal] [rx] [loop]
+//
+// With no benchmark named, all of them run. Numbers are host nanoseconds: compare them with
+// each other, not with the device.
+//
+//   seal  Control frame from a mutated status: running sum and seal(), against the previous
+//         path that rescanned the body for the CRC8 and the frame for the checksum.
+//   rx    Status frames received back to back through the engine loop in 64-byte chunks, in
+//         frames handed to the handlers per second, with every tenth body failing its CRC8.
+//   loop  loop() with nothing to do, and while status frames arrive at 9600 baud with a loop
+//         every 16 ms as in ESPHome, with the Transport calls made per received byte.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "air_conditioner.h"
+#include "appliance_base.h"
+#include "capture.h"
+#include "clock.h"
+#include "frame.h"
+#include "status_data.h"
+#include "port.h"
+#include "transport.h"
+
+using namespace esphome::midea;
+
+// Results are folded in here so the optimiser keeps the work
+static volatile uint8_t sink;
+
+static double nanosPer(std::chrono::steady_clock::time_point start, uint64_t count) {
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / count;
+}
+
+static void mutate(ac::StatusData &status, uint64_t i) {
+  static const ac::Mode MODES[] = {ac::MODE_COOL, ac::MODE_HEAT, ac::MODE_FAN_ONLY, ac::MODE_DRY};
+  status.setTargetTemp(18.0F + i % 12);
+  status.setMode(MODES[i % 4]);
+  status.setPreset(ac::PRESET_NONE);
+  status.setBeeper(i & 1);
+}
+
+static void benchSeal(uint64_t n) {
+  ac::StatusData base;
+  base.seal();
+  uint8_t acc = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < n; ++i) {
+    ac::StatusData status = base;
+    mutate(status, i);
+    status.seal();
+    const Frame frame(0xAC, 0x00, DEVICE_CONTROL, status);
+    acc += frame.data()[frame.size() - 1];
+  }
+  const double sealed = nanosPer(start, n);
+
+  start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < n; ++i) {
+    ac::StatusData status = base;
+    mutate(status, i);
+    // Previous path: CRC8 over the whole body, then the sum over the whole body, here done
+    // by the FrameData constructor from raw bytes
+    uint8_t body[FrameData::MAX_SIZE];
+    const uint8_t size = status.size() - 1;
+    memcpy(body, status.data(), size);
+    body[size] = crc8(body, size);
+    const Frame frame(0xAC, 0x00, DEVICE_CONTROL, FrameData(body, size + 1));
+    acc += frame.data()[frame.size() - 1];
+  }
+  const double rescanned = nanosPer(start, n);
+
+  start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < n; ++i) {
+    ac::StatusData status = base;
+    status.seal();
+    const Frame frame(0xAC, 0x00, DEVICE_CONTROL, status);
+    acc += frame.data()[frame.size() - 1];
+  }
+  const double clean = nanosPer(start, n);
+  sink = acc;
+
+  printf("seal: control frame %.1f ns (previous path %.1f ns), unchanged body %.1f ns\n", sealed, rescanned, clean);
+}
+
+/// Endless byte stream: arrive() makes the next chunk readable, as a UART FIFO would
+class StreamLine : public Transport {
+ public:
+  explicit StreamLine(const std::vector<uint8_t> &stream) : stream_(stream) {}
+  void arrive(size_t size) { this->ready_ += size; }
+  size_t available() override {
+    ++this->calls;
+    return this->ready_;
+  }
+  size_t read(uint8_t *data, size_t size) override {
+    ++this->calls;
+    size = std::min(size, this->ready_);
+    for (size_t i = 0; i < size; ++i) {
+      data[i] = this->stream_[this->pos_++];
+      if (this->pos_ == this->stream_.size())
+        this->pos_ = 0;
+    }
+    this->ready_ -= size;
+    this->received += size;
+    return size;
+  }
+  void write(const uint8_t *data, size_t size) override {}
+  // available() and read() calls, bytes read
+  uint64_t calls{};
+  uint64_t received{};
+
+ protected:
+  const std::vector<uint8_t> &stream_;
+  size_t pos_{};
+  size_t ready_{};
+};
+
+/// Counts the frames handed to the engine handlers
+class RxCounter : public CaptureSink {
+ public:
+  void record(CaptureDirection direction, const uint8_t *data, uint16_t size, uint32_t timestamp) override {
+    this->frames += direction == CAPTURE_RX;
+  }
+  uint64_t frames{};
+};
+
+/// Ten status frames, the last one with a bad body CRC8 if `corrupt`
+static std::vector<uint8_t> statusStream(bool corrupt) {
+  std::vector<uint8_t> stream;
+  for (unsigned i = 0; i < 10; ++i) {
+    uint8_t body[24] = {0xC0, 0x01, 0x44, 0x66, 0x7F, 0x7F, 0x00, 0x30, 0x00, 0x00, 0x00, 0x5A, 0x64};
+    body[1] = i;
+    body[23] = crc8(body, 23) ^ (corrupt && i == 9 ? 0x01 : 0x00);
+    const Frame frame(0xAC, 0x00, DEVICE_QUERY, FrameData(body, sizeof(body)));
+    stream.insert(stream.end(), frame.data(), frame.data() + frame.size());
+  }
+  return stream;
+}
+
+static void benchRx(uint64_t n) {
+  const std::vector<uint8_t> stream = statusStream(true);
+  ManualClock clock;
+  StreamLine line(stream);
+  RxCounter counter;
+  ac::AirConditioner appliance;
+  appliance.setClock(&clock);
+  appliance.setTransport(&line);
+  appliance.setCapture(&counter);
+
+  // A 64-byte chunk per loop, n frames in all
+  const uint64_t loops = n * stream.size() / 10 / 64;
+  const auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < loops; ++i) {
+    line.arrive(64);
+    clock.advance(1);
+    appliance.loop();
+  }
+  const double nanos = nanosPer(start, 1);
+  printf("rx: %.0f frames/s (%.1f MB/s, %u CRC8 failures dropped)\n", counter.frames * 1e9 / nanos,
+         loops * 64 * 1e3 / nanos, static_cast<unsigned>(appliance.getCrcErrors()));
+}
+
+static void benchLoop(uint64_t n) {
+  const std::vector<uint8_t> stream = statusStream(false);
+  ManualClock clock;
+  StreamLine line(stream);
+  ac::AirConditioner appliance;
+  appliance.setClock(&clock);
+  appliance.setTransport(&line);
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < n; ++i) {
+    clock.advance(16);
+    appliance.loop();
+  }
+  const double idle = nanosPer(start, n);
+
+  // 960 characters per second: 15.36 per 16 ms loop
+  const uint64_t calls = line.calls;
+  uint64_t arrived = 0;
+  start = std::chrono::steady_clock::now();
+  for (uint64_t i = 1; i <= n; ++i) {
+    const uint64_t total = i * 1536 / 100;
+    line.arrive(total - arrived);
+    arrived = total;
+    clock.advance(16);
+    appliance.loop();
+  }
+  const double receiving = nanosPer(start, n);
+  printf("loop: idle %.1f ns, receiving at 9600 baud %.1f ns, %.2f transport calls per byte\n", idle, receiving,
+         static_cast<double>(line.calls - calls) / line.received);
+}
+
+int main(int argc, char **argv) {
+  uint64_t n = 1000000;
+  std::vector<std::string> names;
+  port::setLogLevel(port::LOG_LEVEL_ERROR);
+  for (int i = 1; i < argc; ++i) {
+    if (!strncmp(argv[i], "n=", 2))
+      n = std::max(1ULL, strtoull(argv[i] + 2, nullptr, 10));
+    else
+      names.emplace_back(argv[i]);
+  }
+  const auto wanted = [&names](const char *name) {
+    if (names.empty())
+      return true;
+    for (const std::string &it : names)
+      if (it == name)
+        return true;
+    return false;
+  };
+  if (wanted("seal"))
+    benchSeal(n);
+  if (wanted("rx"))
+    benchRx(n);
+  if (wanted("loop"))
+    benchLoop(n);
+  return 0;
+}
@@ -0,0 +1,93 @@
+// Emulated Midea air conditioner on a pseudo-terminal.
+//
+//   midea_emulator [latency=80] [jitter=40] [loss=0] [flip=0] [silence=0]
+//                  [silent_every=0] [silent_for=0] [query_network=0] [seed=1] [-v]
+//
+// Prints the pty slave path; point midea_serial (or a USB-UART adapter) at it.
+// Counters are printed on SIGINT.
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include "emulator.h"
+#include "port.h"
+#include "posix_transport.h"
+
+using namespace esphome::midea;
+
+static volatile sig_atomic_t running = 1;
+
+static void printStats(const EmulatorStats &s) {
+  printf("received=%u rejected=%u status=%u power=%u control=%u caps=%u notify=%u "
+         "sent=%u silenced=%u lost_bytes=%u flipped_bits=%u\n",
+         s.framesReceived, s.framesRejected, s.statusQueries, s.powerQueries, s.controls, s.capabilityQueries,
+         s.networkNotifies, s.responsesSent, s.responsesSilenced, s.bytesLost, s.bitsFlipped);
+}
+
+int main(int argc, char **argv) {
+  EmulatorConfig config;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-v")) {
+      port::setLogLevel(port::LOG_LEVEL_DEBUG);
+      continue;
+    }
+    const char *eq = strchr(argv[i], '=');
+    if (eq == nullptr) {
+      fprintf(stderr, "bad argument: %s\n", argv[i]);
+      return 1;
+    }
+    const std::string key(argv[i], eq - argv[i]);
+    const char *value = eq + 1;
+    if (key == "latency")
+      config.latency = strtoul(value, nullptr, 10);
+    else if (key == "jitter")
+      config.jitter = strtoul(value, nullptr, 10);
+    else if (key == "loss")
+      config.byteLoss = strtof(value, nullptr);
+    else if (key == "flip")
+      config.bitFlip = strtof(value, nullptr);
+    else if (key == "silence")
+      config.silence = strtof(value, nullptr);
+    else if (key == "silent_every")
+      config.silentEvery = strtoul(value, nullptr, 10);
+    else if (key == "silent_for")
+      config.silentFor = strtoul(value, nullptr, 10);
+    else if (key == "query_network")
+      config.queryNetworkInterval = strtoul(value, nullptr, 10);
+    else if (key == "seed")
+      config.seed = strtoul(value, nullptr, 10);
+    else {
+      fprintf(stderr, "unknown option: %s\n", key.c_str());
+      return 1;
+    }
+  }
+
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) || unlockpt(master)) {
+    perror("pty");
+    return 1;
+  }
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  printf("%s\n", ptsname(master));
+  fflush(stdout);
+  signal(SIGINT, [](int) { running = 0; });
+
+  PosixTransport line(master);
+  ApplianceEmulator emulator(config);
+  uint8_t buf[256];
+  while (running) {
+    size_t size = line.read(buf, sizeof(buf));
+    if (size)
+      emulator.write(buf, size);
+    size = emulator.read(buf, sizeof(buf));
+    if (size)
+      line.write(buf, size);
+    usleep(500);
+  }
+  printStats(emulator.stats());
+  close(master);
+}
@@ -0,0 +1,348 @@
+// In-process fleet simulation: many protocol engines against emulated appliances on a virtual clock.
+//
+//   midea_fleet [devices=200] [hours=1] [step=10] [report=10] [commands=6]
+//               [latency=80] [jitter=40] [loss=0] [silence=0] [seed=1] [-v]
+//
+// Every `step` simulated milliseconds each engine runs one loop(). Each device gets about
+// `commands` user commands per simulated hour. Every `report` simulated minutes a line shows
+// the host cost of a loop() call, CPU per simulated device-hour and the live heap, so per-loop
+// cost and heap growth regressions stand out. Allocations made by the engines are counted
+// apart from the emulators'. The summary adds memory per instance and the
+// request latency distribution seen by the engines.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <malloc.h>
+#include "air_conditioner.h"
+#include "capture.h"
+#include "emulator.h"
+#include "clock.h"
+#include "port.h"
+
+using namespace esphome::midea;
+
+/* Heap accounting for the whole process */
+
+static size_t heapLive = 0;
+static uint64_t heapAllocations = 0;
+// Allocations made by the engines, i.e. outside emulator calls
+static uint64_t engineAllocations = 0;
+static bool inEmulator = false;
+
+void *operator new(size_t size) {
+  void *ptr = malloc(size ? size : 1);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  heapLive += malloc_usable_size(ptr);
+  ++heapAllocations;
+  engineAllocations += !inEmulator;
+  return ptr;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *ptr) noexcept {
+  if (ptr == nullptr)
+    return;
+  heapLive -= malloc_usable_size(ptr);
+  free(ptr);
+}
+void operator delete[](void *ptr) noexcept { operator delete(ptr); }
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { operator delete(ptr); }
+
+static uint64_t cpuNanos() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+/// Request latency as seen by the engine: TX to the next RX of the same frame type
+class LatencyProbe : public CaptureSink {
+ public:
+  // 1 ms bins up to 10 s
+  static const size_t BINS = 10000;
+  explicit LatencyProbe(std::vector<uint64_t> &histogram) : histogram_(histogram) {}
+  void record(CaptureDirection direction, const uint8_t *data, uint16_t size, uint32_t timestamp) override {
+    if (size < 10)
+      return;
+    const uint8_t type = data[9];
+    if (direction == CAPTURE_TX) {
+      this->pending_ = type != NETWORK_NOTIFY && type != QUERY_NETWORK;
+      this->type_ = type;
+      this->sent_ = timestamp;
+    } else if (direction == CAPTURE_RX && this->pending_ && type == this->type_) {
+      ++this->histogram_[std::min<size_t>((timestamp - this->sent_) / 1000, BINS - 1)];
+      this->pending_ = false;
+    }
+  }
+ protected:
+  std::vector<uint64_t> &histogram_;
+  uint32_t sent_{};
+  uint8_t type_{};
+  bool pending_{};
+};
+
+/// Emulator seen through the Transport interface, with its allocations kept apart
+class EmulatorLine : public Transport {
+ public:
+  explicit EmulatorLine(ApplianceEmulator &emulator) : emulator_(emulator) {}
+  size_t available() override {
+    inEmulator = true;
+    const size_t size = this->emulator_.available();
+    inEmulator = false;
+    return size;
+  }
+  size_t read(uint8_t *data, size_t size) override {
+    inEmulator = true;
+    size = this->emulator_.read(data, size);
+    inEmulator = false;
+    return size;
+  }
+  void write(const uint8_t *data, size_t size) override {
+    inEmulator = true;
+    this->emulator_.write(data, size);
+    inEmulator = false;
+  }
+ protected:
+  ApplianceEmulator &emulator_;
+};
+
+struct Device {
+  Device(const EmulatorConfig &config, const Clock *clock, std::vector<uint64_t> &histogram)
+      : emulator(config, clock), line(emulator), probe(histogram), rng(config.seed) {}
+  ApplianceEmulator emulator;
+  EmulatorLine line;
+  ac::AirConditioner appliance;
+  LatencyProbe probe;
+  std::mt19937 rng;
+  uint64_t nextCommand{};
+};
+
+static uint64_t nextCommandTime(Device &device, uint64_t now, double perHour) {
+  if (perHour <= 0)
+    return UINT64_MAX;
+  std::exponential_distribution<double> gap(perHour / 3600e6);
+  return now + static_cast<uint64_t>(gap(device.rng));
+}
+
+static void sendCommand(Device &device) {
+  static const ac::Mode MODES[] = {ac::MODE_OFF, ac::MODE_COOL, ac::MODE_HEAT, ac::MODE_FAN_ONLY};
+  static const ac::FanMode FANS[] = {ac::FAN_AUTO, ac::FAN_LOW, ac::FAN_MEDIUM, ac::FAN_HIGH};
+  ac::Control control;
+  switch (device.rng() % 3) {
+    case 0:
+      control.targetTemp = 18.0F + device.rng() % 12;
+      break;
+    case 1:
+      control.mode = MODES[device.rng() % 4];
+      break;
+    default:
+      control.fanMode = FANS[device.rng() % 4];
+      break;
+  }
+  device.appliance.control(control);
+}
+
+static double percentile(const std::vector<uint64_t> &histogram, double p) {
+  uint64_t total = 0;
+  for (uint64_t count : histogram)
+    total += count;
+  const uint64_t rank = static_cast<uint64_t>(p * total);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    seen += histogram[i];
+    if (seen > rank)
+      return i + 1;
+  }
+  return histogram.size();
+}
+
+int main(int argc, char **argv) {
+  unsigned devices = 200;
+  double hours = 1.0;
+  uint32_t stepMs = 10;
+  uint32_t reportMin = 10;
+  double commands = 6.0;
+  EmulatorConfig config;
+  port::setLogLevel(port::LOG_LEVEL_ERROR);
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-v")) {
+      port::setLogLevel(port::LOG_LEVEL_WARN);
+      continue;
+    }
+    const char *eq = strchr(argv[i], '=');
+    if (eq == nullptr) {
+      fprintf(stderr, "bad argument: %s\n", argv[i]);
+      return 1;
+    }
+    const std::string key(argv[i], eq - argv[i]);
+    const char *value = eq + 1;
+    if (key == "devices")
+      devices = strtoul(value, nullptr, 10);
+    else if (key == "hours")
+      hours = strtod(value, nullptr);
+    else if (key == "step")
+      stepMs = std::max(1UL, strtoul(value, nullptr, 10));
+    else if (key == "report")
+      reportMin = std::max(1UL, strtoul(value, nullptr, 10));
+    else if (key == "commands")
+      commands = strtod(value, nullptr);
+    else if (key == "latency")
+      config.latency = strtoul(value, nullptr, 10);
+    else if (key == "jitter")
+      config.jitter = strtoul(value, nullptr, 10);
+    else if (key == "loss")
+      config.byteLoss = strtof(value, nullptr);
+    else if (key == "silence")
+      config.silence = strtof(value, nullptr);
+    else if (key == "seed")
+      config.seed = strtoul(value, nullptr, 10);
+    else {
+      fprintf(stderr, "unknown option: %s\n", key.c_str());
+      return 1;
+    }
+  }
+
+  ManualClock clock;
+  std::vector<uint64_t> histogram(LatencyProbe::BINS);
+  const size_t heapBefore = heapLive;
+  std::vector<std::unique_ptr<Device>> fleet;
+  fleet.reserve(devices);
+  for (unsigned i = 0; i < devices; ++i) {
+    EmulatorConfig deviceConfig = config;
+    deviceConfig.seed = config.seed + i;
+    fleet.emplace_back(new Device(deviceConfig, &clock, histogram));
+    Device &device = *fleet.back();
+    device.appliance.setClock(&clock);
+    device.appliance.setTransport(&device.line);
+    device.appliance.setCapture(&device.probe);
+    device.appliance.setAutoconf(true);
+    device.appliance.setup();
+    device.nextCommand = nextCommandTime(device, 0, commands);
+  }
+  const size_t heapSetup = heapLive;
+
+  printf("%u devices, %.2f simulated hours, %u ms step\n\n", devices, hours, stepMs);
+  printf("%8s %10s %14s %12s %12s %14s %14s\n", "sim min", "ns/loop", "cpu ms/dev-h", "heap KiB", "heap delta", "allocs/dev-min", "engine/dev-min");
+  const uint64_t step = stepMs * 1000ULL;
+  const uint64_t report = reportMin * 60000000ULL;
+  const uint64_t end = static_cast<uint64_t>(hours * 3600e6);
+  uint64_t now = 0;
+  uint64_t loops = 0;
+  uint64_t cpuTotal = 0;
+  size_t heapAfterFirst = 0;
+  while (now < end) {
+    const uint64_t intervalEnd = std::min(now + report, end);
+    const uint64_t intervalStart = now;
+    const uint64_t allocationsStart = heapAllocations;
+    const uint64_t engineAllocationsStart = engineAllocations;
+    const size_t heapStart = heapLive;
+    const uint64_t cpuStart = cpuNanos();
+    uint64_t intervalLoops = 0;
+    for (; now < intervalEnd; now += step) {
+      clock.advance(stepMs);
+      for (auto &device : fleet) {
+        if (now >= device->nextCommand) {
+          sendCommand(*device);
+          device->nextCommand = nextCommandTime(*device, now, commands);
+        }
+        device->appliance.loop();
+      }
+      intervalLoops += fleet.size();
+    }
+    const uint64_t cpu = cpuNanos() - cpuStart;
+    const double deviceHours = devices * (now - intervalStart) / 3600e6;
+    const double deviceMinutes = deviceHours * 60;
+    cpuTotal += cpu;
+    loops += intervalLoops;
+    if (!heapAfterFirst)
+      heapAfterFirst = heapLive;
+    printf("%8.0f %10.1f %14.2f %12.1f %+12ld %14.2f %14.2f\n", now / 60e6,
+           intervalLoops ? static_cast<double>(cpu) / intervalLoops : 0.0, cpu / 1e6 / deviceHours, heapLive / 1024.0,
+           static_cast<long>(heapLive) - static_cast<long>(heapStart),
+           (heapAllocations - allocationsStart) / deviceMinutes,
+           (engineAllocations - engineAllocationsStart) / deviceMinutes);
+    fflush(stdout);
+  }
+
+  EmulatorStats total{};
+  for (auto &device : fleet) {
+    const EmulatorStats &s = device->emulator.stats();
+    total.statusQueries += s.statusQueries;
+    total.powerQueries += s.powerQueries;
+    total.controls += s.controls;
+    total.capabilityQueries += s.capabilityQueries;
+    total.networkNotifies += s.networkNotifies;
+    total.responsesSent += s.responsesSent;
+    total.responsesSilenced += s.responsesSilenced;
+    total.framesRejected += s.framesRejected;
+    total.framesReceived += s.framesReceived;
+  }
+  size_t timers = 0;
+  uint8_t queueHighWater = 0;
+  uint64_t droppedRequests = 0;
+  uint64_t preemptedRequests = 0;
+  uint64_t coalescedRequests = 0;
+  unsigned autoconfOk = 0;
+  uint64_t pacedSends = 0, delayedSends = 0, pacingDelay = 0;
+  uint32_t maxPacingDelay = 0;
+  double srtt[2] = {}, rttvar[2] = {}, timeout[2] = {};
+  const FrameType rttTypes[2] = {DEVICE_QUERY, DEVICE_CONTROL};
+  for (auto &device : fleet) {
+    timers = std::max(timers, device->appliance.getTimerCount());
+    queueHighWater = std::max(queueHighWater, device->appliance.getQueueHighWater());
+    droppedRequests += device->appliance.getDroppedRequests();
+    preemptedRequests += device->appliance.getPreemptedRequests();
+    coalescedRequests += device->appliance.getCoalescedRequests();
+    autoconfOk += device->appliance.getAutoconfStatus() == AUTOCONF_OK;
+    const Pacer &pacer = device->appliance.getPacer();
+    pacedSends += pacer.getSent();
+    delayedSends += pacer.getDelayed();
+    pacingDelay += pacer.getTotalDelay();
+    maxPacingDelay = std::max(maxPacingDelay, pacer.getMaxDelay());
+    for (int i = 0; i < 2; ++i) {
+      srtt[i] += device->appliance.getRtt(rttTypes[i]).srtt();
+      rttvar[i] += device->appliance.getRtt(rttTypes[i]).rttvar();
+      timeout[i] += device->appliance.getResponseTimeout(rttTypes[i]);
+    }
+  }
+  uint64_t responses = 0;
+  for (uint64_t count : histogram)
+    responses += count;
+  const double deviceHours = devices * end / 3600e6;
+  printf("\nCPU per simulated device-hour: %.2f ms (%.1f ns per loop, %" PRIu64 " loops)\n",
+         cpuTotal / 1e6 / deviceHours, loops ? static_cast<double>(cpuTotal) / loops : 0.0, loops);
+  printf("Memory per instance: %zu bytes object + %.0f bytes heap after setup, %.0f bytes heap after first interval\n",
+         sizeof(Device), static_cast<double>(heapSetup - heapBefore) / devices,
+         static_cast<double>(heapAfterFirst - heapBefore) / devices);
+  printf("Heap growth after first interval: %+ld bytes total, at most %zu timers per engine\n",
+         static_cast<long>(heapLive) - static_cast<long>(heapAfterFirst), timers);
+  printf("Engine heap allocations: %" PRIu64 " (%.2f per frame sent)\n", engineAllocations,
+         total.framesReceived ? static_cast<double>(engineAllocations) / total.framesReceived : 0.0);
+  printf("Request pool: %u of %u slots used at most, %" PRIu64 " requests dropped, %" PRIu64 " preempted, %" PRIu64
+         " coalesced\n",
+         queueHighWater, fleet.empty() ? 0u : fleet.front()->appliance.getQueueSize(), droppedRequests,
+         preemptedRequests, coalescedRequests);
+  printf("Autoconf completed on %u of %zu devices\n", autoconfOk, fleet.size());
+  printf("Pacer: %" PRIu64 " of %" PRIu64 " sends delayed, mean %.0f ms, max %u ms\n", delayedSends, pacedSends,
+         delayedSends ? static_cast<double>(pacingDelay) / delayedSends : 0.0, maxPacingDelay);
+  for (int i = 0; i < 2 && !fleet.empty(); ++i)
+    printf("Mean %s RTT: srtt %.0f ms, rttvar %.0f ms, timeout %.0f ms\n", i ? "control" : "query",
+           srtt[i] / fleet.size(), rttvar[i] / fleet.size(), timeout[i] / fleet.size());
+  printf("Requests answered: %" PRIu64 ", latency p50 %.0f ms, p90 %.0f ms, p99 %.0f ms, p99.9 %.0f ms\n", responses,
+         percentile(histogram, 0.5), percentile(histogram, 0.9), percentile(histogram, 0.99),
+         percentile(histogram, 0.999));
+  printf("Appliance side: status=%u power=%u control=%u caps=%u notify=%u sent=%u silenced=%u rejected=%u\n",
+         total.statusQueries,
+         total.powerQueries, total.controls, total.capabilityQueries, total.networkNotifies, total.responsesSent,
+         total.responsesSilenced, total.framesRejected);
+  return 0;
+}
@@ -0,0 +1,64 @@
+// Run the protocol engine on a Linux host against a serial port or pty.
+//
+//   midea_serial /dev/ttyUSB0 [baud] [-v] [-c capture.bin]
+//
+// Prints the appliance state on every update. Useful for profiling the engine
+// with ordinary host tools (perf, valgrind, heaptrack). `-c` records the session for midea_replay.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include "air_conditioner.h"
+#include "capture_file.h"
+#include "posix_transport.h"
+
+using namespace esphome::midea;
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <device> [baud] [-v] [-c capture]\n", argv[0]);
+    return 1;
+  }
+  uint32_t baudRate = 9600;
+  const char *capturePath = nullptr;
+  for (int i = 2; i < argc; ++i) {
+    if (!strcmp(argv[i], "-v"))
+      port::setLogLevel(port::LOG_LEVEL_DEBUG);
+    else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+      capturePath = argv[++i];
+    else
+      baudRate = strtoul(argv[i], nullptr, 10);
+  }
+
+  PosixTransport transport;
+  if (!transport.open(argv[1], baudRate)) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  CaptureFileWriter capture;
+  if (capturePath != nullptr && !capture.open(capturePath)) {
+    perror(capturePath);
+    return 1;
+  }
+
+  ac::AirConditioner appliance;
+  appliance.setTransport(&transport);
+  if (capturePath != nullptr)
+    appliance.setCapture(&capture);
+  appliance.setBaudRate(baudRate);
+  appliance.setAutoconf(true);
+  appliance.addOnStateCallback([&appliance]() {
+    printf("mode=%d preset=%d fan=%d swing=%d target=%.1f indoor=%.1f outdoor=%.1f power=%.1f\n",
+           appliance.getMode(), appliance.getPreset(), appliance.getFanMode(), appliance.getSwingMode(),
+           appliance.getTargetTemp(), appliance.getIndoorTemp(), appliance.getOutdoorTemp(),
+           appliance.getPowerUsage());
+    fflush(stdout);
+  });
+  appliance.setup();
+  for (;;) {
+    appliance.loop();
+    usleep(1000);
+  }
+}
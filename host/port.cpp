@@ -0,0 +1,37 @@
+#include "host_port.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+
+namespace esphome {
+namespace midea {
+namespace port {
+
+static const auto START = std::chrono::steady_clock::now();
+static LogLevel logLevel = LOG_LEVEL_INFO;
+
+uint32_t millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - START).count();
+}
+
+uint32_t micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - START).count();
+}
+
+
+void setLogLevel(LogLevel level) { logLevel = level; }
+LogLevel getLogLevel() { return logLevel; }
+
+void log(LogLevel level, const char *tag, const char *format, ...) {
+  static const char LETTERS[] = "-EWICDV";
+  fprintf(stderr, "[%c][%s] ", LETTERS[level], tag);
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+}  // namespace port
+}  // namespace midea
+}  // namespace esphome
@@ -0,0 +1,87 @@
+#include "posix_transport.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace esphome {
+namespace midea {
+
+static speed_t toSpeed(uint32_t baudRate) {
+  switch (baudRate) {
+    case 2400:
+      return B2400;
+    case 4800:
+      return B4800;
+    case 19200:
+      return B19200;
+    case 38400:
+      return B38400;
+    case 57600:
+      return B57600;
+    case 115200:
+      return B115200;
+    default:
+      return B9600;
+  }
+}
+
+bool PosixTransport::open(const char *path, uint32_t baudRate) {
+  this->close();
+  const int fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0)
+    return false;
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, toSpeed(baudRate));
+    cfsetospeed(&tio, toSpeed(baudRate));
+    tio.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  this->fd_ = fd;
+  this->owned_ = true;
+  return true;
+}
+
+void PosixTransport::close() {
+  if (this->owned_ && this->fd_ >= 0)
+    ::close(this->fd_);
+  this->fd_ = -1;
+  this->owned_ = false;
+}
+
+size_t PosixTransport::available() {
+  int count = 0;
+  if (this->fd_ < 0 || ioctl(this->fd_, FIONREAD, &count) < 0)
+    return 0;
+  return count;
+}
+
+size_t PosixTransport::read(uint8_t *data, size_t size) {
+  const ssize_t count = ::read(this->fd_, data, size);
+  return count > 0 ? count : 0;
+}
+
+void PosixTransport::write(const uint8_t *data, size_t size) {
+  while (size) {
+    const ssize_t count = ::write(this->fd_, data, size);
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN)
+        return;
+      // Non-blocking descriptor is full: wait until it drains
+      struct pollfd pfd = {this->fd_, POLLOUT, 0};
+      poll(&pfd, 1, 100);
+      continue;
+    }
+    data += count;
+    size -= count;
+  }
+}
+
+}  // namespace midea
+}  // namespace esphome
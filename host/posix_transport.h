@@ -0,0 +1,29 @@
+#pragma once
+#include "transport.h"
+
+namespace esphome {
+namespace midea {
+
+/// Transport over a POSIX file descriptor: serial port, pty or pipe
+class PosixTransport : public Transport {
+ public:
+  PosixTransport() = default;
+  /// Use an already open descriptor (pty master, socketpair end). It is not closed.
+  explicit PosixTransport(int fd) : fd_(fd) {}
+  ~PosixTransport() override { this->close(); }
+  PosixTransport(const PosixTransport &) = delete;
+  PosixTransport &operator=(const PosixTransport &) = delete;
+  /// Open a serial device or pty slave in raw 8N1 mode
+  bool open(const char *path, uint32_t baudRate = 9600);
+  void close();
+  int fd() const { return this->fd_; }
+  size_t available() override;
+  size_t read(uint8_t *data, size_t size) override;
+  void write(const uint8_t *data, size_t size) override;
+ private:
+  int fd_{-1};
+  bool owned_{false};
+};
+
+}  // namespace midea
+}  // namespace esphome
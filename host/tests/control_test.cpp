@@ -0,0 +1,40 @@
+// Controls go out one at a time, the latest pending one next. A SET_STATUS cancelled in flight
+// by another user command fails like a timed-out one, so later controls are still sent.
+
+#include "test_support.h"
+
+using namespace esphome::midea;
+
+/// Air conditioner with the user command entry point exposed
+class CommandingAirConditioner : public ac::AirConditioner {
+ public:
+  using ApplianceBase::sendUserCommand;
+};
+
+int main() {
+  // Slow answers keep the control in flight when the other command comes
+  EmulatorConfig config;
+  config.latency = 400;
+  config.jitter = 0;
+  test::Rig<CommandingAirConditioner> rig(config);
+  rig.appliance.setup();
+  rig.run(60000);
+
+  ac::Control first;
+  first.targetTemp = 20.0F;
+  rig.appliance.control(first);
+  rig.run(100);
+  const uint32_t controls = rig.emulator.stats().controls;
+  CHECK(controls > 0);
+  rig.appliance.sendUserCommand(DEVICE_QUERY, FrameData({0x41, 0x06}), [](FrameView data) { return RESPONSE_OK; });
+  rig.run(10000);
+
+  ac::Control second;
+  second.targetTemp = 25.0F;
+  rig.appliance.control(second);
+  rig.run(10000);
+  CHECK(rig.emulator.stats().controls == controls + 1);
+  CHECK(rig.emulator.state().target == 25.0F);
+  CHECK(rig.appliance.getTargetTemp() == 25.0F);
+  return test::finish();
+}
@@ -0,0 +1,45 @@
+// Frame bodies live in a fixed inline buffer: oversized input is truncated to it, a full body
+// is not sealed past its end, and a raw frame with a short LENGTH byte has an empty body. The
+// emulator takes the longest frame like any other.
+
+#include <cstring>
+#include "frame.h"
+#include "test_support.h"
+
+using namespace esphome::midea;
+
+int main() {
+  uint8_t raw[Frame::MAX_SIZE];
+  memset(raw, 0x5A, sizeof(raw));
+
+  const FrameData copied(raw, 255);
+  CHECK(copied.size() == FrameData::MAX_SIZE);
+  const FrameData zeroed(uint8_t{255});
+  CHECK(zeroed.size() == FrameData::MAX_SIZE);
+
+  FrameData full(raw, FrameData::MAX_SIZE);
+  full.appendCRC();
+  CHECK(full.size() == FrameData::MAX_SIZE);
+  full.seal();
+  CHECK(full.size() == FrameData::MAX_SIZE);
+
+  // Room for the CRC8 only: the body fills the longest frame exactly
+  FrameData largest(raw, FrameData::MAX_SIZE - 1);
+  largest.seal();
+  CHECK(largest.size() == FrameData::MAX_SIZE);
+  CHECK(largest.hasValidCRC());
+  const Frame frame(0xAC, 0x00, 0x03, largest);
+  CHECK(frame.size() == 256);
+  CHECK(frame.isValid());
+  CHECK(frame.getData().size() == FrameData::MAX_SIZE);
+  ApplianceEmulator emulator;
+  emulator.write(frame.data(), frame.size());
+  CHECK(emulator.stats().framesReceived == 1);
+
+  const uint8_t shortHeader[] = {0xAA, 0x05, 0xAC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x41};
+  CHECK(Frame(shortHeader, sizeof(shortHeader)).getData().size() == 0);
+  // LENGTH beyond the bytes held: the body stops at the end of the buffer
+  const uint8_t truncated[] = {0xAA, 0x20, 0xAC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x41, 0x81};
+  CHECK(Frame(truncated, sizeof(truncated)).getData().size() == 2);
+  return test::finish();
+}
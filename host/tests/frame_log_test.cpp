@@ -0,0 +1,65 @@
+// Frame hex dumps for the TX/RX debug logs: exact text, no heap, and an engine logging at
+// DEBUG level exchanges frames without allocating.
+
+#include <cstring>
+#include <string>
+#include "frame.h"
+#include "test_support.h"
+
+using namespace esphome::midea;
+
+static std::string reference(const Frame &frame) {
+  std::string text;
+  char byte[4];
+  for (uint16_t i = 0; i < frame.size(); ++i) {
+    snprintf(byte, sizeof(byte), i ? " %02X" : "%02X", frame.data()[i]);
+    text += byte;
+  }
+  return text;
+}
+
+int main() {
+  const Frame empty{};
+  CHECK(strcmp(empty.toString().c_str(), "") == 0);
+
+  FrameData body({0x41, 0x81, 0x00, 0xFF, 0x03, 0xFF, 0x00, 0x02});
+  body.seal();
+  const Frame query(0xAC, 0x00, 0x03, body);
+  CHECK(reference(query) == query.toString().c_str());
+
+  uint8_t raw[Frame::MAX_SIZE];
+  for (uint16_t i = 0; i < Frame::MAX_SIZE; ++i)
+    raw[i] = static_cast<uint8_t>(i * 7);
+  const Frame full(raw, Frame::MAX_SIZE);
+  CHECK(strlen(full.toString().c_str()) == Frame::MAX_SIZE * 3 - 1);
+  CHECK(reference(full) == full.toString().c_str());
+
+  uint64_t start = test::allocations();
+  size_t length = 0;
+  for (int i = 0; i < 1000; ++i)
+    length += strlen(query.toString().c_str()) + strlen(full.toString().c_str());
+  CHECK(length > 0);
+  CHECK(test::allocations() == start);
+
+  // The whole engine at DEBUG level, which formats every TX and RX frame. Logs go to stderr;
+  // test results go to stdout.
+  if (freopen("/dev/null", "w", stderr) == nullptr)
+    return 1;
+  port::setLogLevel(port::LOG_LEVEL_DEBUG);
+  test::Rig<> rig;
+  rig.appliance.setAutoconf(true);
+  rig.appliance.setup();
+  rig.run(60000);
+  const uint32_t sent = rig.appliance.getPacer().getSent();
+  start = test::allocations();
+  ac::Control control;
+  control.targetTemp = 21.0F;
+  rig.appliance.control(control);
+  rig.run(600000);
+  const uint64_t allocated = test::allocations() - start;
+  printf("DEBUG logging: %u frames sent, %llu allocations\n", rig.appliance.getPacer().getSent() - sent,
+         static_cast<unsigned long long>(allocated));
+  CHECK(rig.appliance.getPacer().getSent() - sent > 10);
+  CHECK(allocated == 0);
+  return test::finish();
+}
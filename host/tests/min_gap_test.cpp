@@ -0,0 +1,50 @@
+// Two frames are never closer than the minimum gap, including those sent outside the paced
+// queue: the second capabilities page, sent as soon as the first is answered, and the answer to
+// a QUERY_NETWORK from the unit.
+
+#include <algorithm>
+#include <vector>
+#include "capture.h"
+#include "test_support.h"
+
+using namespace esphome::midea;
+
+/// Timestamps of the frames sent by the engine, in microseconds
+class TxTimes : public CaptureSink {
+ public:
+  void record(CaptureDirection direction, const uint8_t *data, uint16_t size, uint32_t timestamp) override {
+    test::AllocationPause pause;
+    if (direction == CAPTURE_TX)
+      this->times.push_back(timestamp);
+  }
+  std::vector<uint32_t> times;
+};
+
+int main() {
+  EmulatorConfig config;
+  // Answers and network queries land well inside the gap
+  config.latency = 40;
+  config.jitter = 0;
+  config.queryNetworkInterval = 3000;
+  test::Rig<> rig(config);
+  const uint32_t minGap = 300;
+  rig.appliance.setPeriod(1000);
+  rig.appliance.setMinGap(minGap);
+  rig.appliance.setAutoconf(true);
+  TxTimes tx;
+  rig.appliance.setCapture(&tx);
+  rig.appliance.setup();
+  rig.run(10 * 60000, 1);
+
+  uint32_t closest = UINT32_MAX;
+  for (size_t i = 1; i < tx.times.size(); ++i)
+    closest = std::min(closest, tx.times[i] - tx.times[i - 1]);
+  const EmulatorStats &stats = rig.emulator.stats();
+  printf("%zu frames sent, closest two %u us apart, %u capability pages, %u QUERY_NETWORK answers\n",
+         tx.times.size(), closest, stats.capabilityQueries, stats.networkQueries);
+  CHECK(stats.capabilityQueries >= 2);
+  CHECK(stats.networkQueries >= 150);
+  CHECK(closest >= minGap * 1000);
+  CHECK(rig.appliance.getAutoconfStatus() == AUTOCONF_OK);
+  return test::finish();
+}
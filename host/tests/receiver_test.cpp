@@ -0,0 +1,130 @@
+// Receiver robustness: real frames mixed with random noise and fake start/length pairs must
+// still be recovered, whatever the chunking of the UART reads. Frames whose body fails its
+// CRC8 never reach the handlers, and a stale partial frame flushed after an idle gap is
+// rescanned for a frame that started inside it. Rejected and flushed bytes are captured.
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+#include "capture.h"
+#include "frame.h"
+#include "test_support.h"
+
+using namespace esphome::midea;
+
+/// Byte stream read in fixed-size chunks, one chunk per loop
+class ChunkedLine : public Transport {
+ public:
+  ChunkedLine(const std::vector<uint8_t> &stream, size_t chunk) : stream_(stream), chunk_(chunk) {}
+  /// The next chunk becomes readable
+  void arrive() { this->end_ = std::min(this->end_ + this->chunk_, this->stream_.size()); }
+  bool done() const { return this->pos_ == this->stream_.size(); }
+  size_t available() override { return this->end_ - this->pos_; }
+  size_t read(uint8_t *data, size_t size) override {
+    size = std::min(size, this->end_ - this->pos_);
+    std::copy_n(this->stream_.begin() + this->pos_, size, data);
+    this->pos_ += size;
+    return size;
+  }
+  void write(const uint8_t *data, size_t size) override {}
+
+ protected:
+  const std::vector<uint8_t> &stream_;
+  const size_t chunk_;
+  size_t pos_{};
+  size_t end_{};
+};
+
+/// Sequence numbers of the frames handed to the engine handlers, and the receiver counters
+class Recovered : public CaptureSink {
+ public:
+  void record(CaptureDirection direction, const uint8_t *data, uint16_t size, uint32_t timestamp) override {
+    if (direction == CAPTURE_RX && size > 13)
+      this->ids.insert(data[11] | data[12] << 8);
+    this->rejected += direction == CAPTURE_RX_REJECTED;
+    this->flushedRecords += direction == CAPTURE_RX_FLUSHED;
+  }
+  std::set<unsigned> ids;
+  uint32_t rejected{};
+  uint32_t flushedRecords{};
+  uint32_t crcErrors{};
+  uint32_t flushed{};
+  uint32_t flushedBytes{};
+};
+
+static void appendFrame(std::vector<uint8_t> &stream, unsigned id, bool badCRC = false) {
+  uint8_t body[24] = {0xC0, 0x00, 0x00, 0x66, 0x7F, 0x7F, 0x00, 0x30, 0x00, 0x00, 0x00, 0x5A, 0x64};
+  body[1] = id & 0xFF;
+  body[2] = id >> 8;
+  body[23] = crc8(body, 23) ^ (badCRC ? 0x01 : 0x00);
+  const Frame frame(0xAC, 0x00, 0x03, FrameData(body, sizeof(body)));
+  stream.insert(stream.end(), frame.data(), frame.data() + frame.size());
+}
+
+/// Feed the whole stream to a fresh engine in `chunk`-byte reads, 1 ms apart, then leave
+/// the line idle for 100 ms
+static Recovered receive(const std::vector<uint8_t> &stream, size_t chunk) {
+  ManualClock clock;
+  ChunkedLine line(stream, chunk);
+  Recovered recovered;
+  ac::AirConditioner appliance;
+  appliance.setClock(&clock);
+  appliance.setTransport(&line);
+  appliance.setCapture(&recovered);
+  while (!line.done()) {
+    line.arrive();
+    clock.advance(1);
+    appliance.loop();
+  }
+  for (unsigned i = 0; i < 100; ++i) {
+    clock.advance(1);
+    appliance.loop();
+  }
+  recovered.crcErrors = appliance.getCrcErrors();
+  recovered.flushed = appliance.getFlushedFrames();
+  recovered.flushedBytes = appliance.getFlushedBytes();
+  return recovered;
+}
+
+int main() {
+  static const unsigned FRAMES = 500;
+  std::mt19937 rng(7);
+  std::vector<uint8_t> stream;
+  for (unsigned id = 0; id < FRAMES; ++id) {
+    // Noise, then sometimes a fake start byte with a plausible length just ahead of the frame
+    for (unsigned n = rng() % 9; n > 0; --n)
+      stream.push_back(rng());
+    if (rng() % 3 == 0) {
+      stream.push_back(0xAA);
+      stream.push_back(11 + rng() % 40);
+    }
+    appendFrame(stream, id);
+  }
+  for (size_t chunk : {1, 7, 64, 256}) {
+    const size_t recovered = receive(stream, chunk).ids.size();
+    printf("chunk %3zu: %zu of %u frames recovered\n", chunk, recovered, FRAMES);
+    CHECK(recovered >= FRAMES * 99 / 100);
+  }
+
+  // Intact framing, bad body CRC8: counted and dropped
+  stream.clear();
+  appendFrame(stream, 1);
+  appendFrame(stream, 2, true);
+  appendFrame(stream, 3);
+  Recovered recovered = receive(stream, 16);
+  CHECK(recovered.crcErrors == 1);
+  CHECK(recovered.rejected == 1);
+  CHECK(recovered.ids == std::set<unsigned>({1, 3}));
+
+  // A truncated frame whose length swallows the next one: once the line goes idle, only the
+  // three stale bytes are dropped and the frame behind them is received
+  stream = {0xAA, 0xF0, 0x01};
+  appendFrame(stream, 4);
+  recovered = receive(stream, 64);
+  CHECK(recovered.ids == std::set<unsigned>({4}));
+  CHECK(recovered.flushed == 1);
+  CHECK(recovered.flushedRecords == 1);
+  CHECK(recovered.flushedBytes == 3);
+  return test::finish();
+}
@@ -0,0 +1,44 @@
+// Queuing, sending and retrying requests never allocates: requests come from a fixed pool and
+// their handlers are Delegates stored inline. The emulated unit ignores about a third of the
+// requests, so responses time out and requests are sent again.
+
+#include "test_support.h"
+
+using namespace esphome::midea;
+
+int main() {
+  EmulatorConfig config;
+  config.silence = 0.3F;
+  config.queryNetworkInterval = 20000;
+  test::Rig<> rig(config);
+  rig.appliance.setAutoconf(true);
+  rig.appliance.setup();
+  // Pools, the emulator and the first status are set up before counting starts
+  rig.run(60000);
+
+  const uint64_t start = test::allocations();
+  const EmulatorStats before = rig.emulator.stats();
+  const uint32_t sent = rig.appliance.getPacer().getSent();
+  for (unsigned i = 0; i < 200; ++i) {
+    // User commands, merged while one is in flight, around the background polls
+    ac::Control control;
+    control.targetTemp = 18.0F + i % 12;
+    rig.appliance.control(control);
+    if (i % 3 == 0) {
+      ac::Control fan;
+      fan.fanMode = i % 2 ? ac::FAN_HIGH : ac::FAN_LOW;
+      rig.appliance.control(fan);
+    }
+    rig.run(3000);
+  }
+  const uint64_t allocated = test::allocations() - start;
+  const EmulatorStats after = rig.emulator.stats();
+  const uint32_t frames = rig.appliance.getPacer().getSent() - sent;
+  const uint32_t ignored = after.responsesSilenced - before.responsesSilenced;
+  printf("%u frames sent, %u ignored by the unit, %llu allocations\n", frames, ignored,
+         static_cast<unsigned long long>(allocated));
+  CHECK(ignored > 50);
+  CHECK(after.controls - before.controls >= 100);
+  CHECK(allocated == 0);
+  return test::finish();
+}
@@ -0,0 +1,70 @@
+// A user command arriving with the request pool full displaces the newest queued background
+// request. That request fails like any other: its onError and those of the queries merged
+// into it run, so callers waiting on it (e.g. autoconf) are not left hanging. A background
+// request parked for a user command is never the one displaced: it resumes afterwards.
+
+#include <string>
+#include "test_support.h"
+
+using namespace esphome::midea;
+
+/// Air conditioner with the queuing entry points exposed
+class QueuingAirConditioner : public ac::AirConditioner {
+ public:
+  using ApplianceBase::queueQuery_;
+  using ApplianceBase::queueRequest_;
+  using ApplianceBase::queueRequestPriority_;
+  using ApplianceBase::sendUserCommand;
+};
+
+static std::string failed;
+
+int main() {
+  QueuingAirConditioner appliance;
+  appliance.setQueueSize(3);
+  appliance.queueRequest_(DEVICE_QUERY, FrameData({0x41, 0x01}), nullptr, nullptr, [] { failed += 'A'; });
+  appliance.queueRequest_(DEVICE_QUERY, FrameData({0x41, 0x02}), nullptr, nullptr, [] { failed += 'B'; });
+  appliance.queueQuery_(DEVICE_QUERY, FrameData({0x41, 0x03}), nullptr, nullptr, [] { failed += 'C'; });
+  // Merged into C as a waiter
+  appliance.queueQuery_(DEVICE_QUERY, FrameData({0x41, 0x03}), nullptr, nullptr, [] { failed += 'c'; });
+  CHECK(appliance.getQueueDepth(PRIORITY_BACKGROUND) == 3);
+  CHECK(appliance.getCoalescedRequests() == 1);
+
+  appliance.queueRequestPriority_(DEVICE_CONTROL, FrameData({0x40, 0x00}), nullptr, nullptr, [] { failed += 'U'; });
+  CHECK(failed == "Cc");
+  CHECK(appliance.getDroppedRequests() == 1);
+  CHECK(appliance.getQueueDepth(PRIORITY_BACKGROUND) == 2);
+  CHECK(appliance.getQueueDepth(PRIORITY_USER_COMMAND) == 1);
+
+  // A background request finding the pool full fails at once, displacing nothing
+  appliance.queueRequest_(DEVICE_QUERY, FrameData({0x41, 0x04}), nullptr, nullptr, [] { failed += 'D'; });
+  CHECK(failed == "CcD");
+  CHECK(appliance.getQueueDepth(PRIORITY_BACKGROUND) == 2);
+
+  // Slow answers keep the background request in flight when the user command comes
+  EmulatorConfig config;
+  config.latency = 400;
+  config.jitter = 0;
+  test::Rig<QueuingAirConditioner> rig(config);
+  rig.appliance.setQueueSize(3);
+  rig.appliance.setup();
+  rig.run(60000);
+  CHECK(rig.appliance.getQueueDepth(PRIORITY_BACKGROUND) == 0);
+  std::string parked;
+  const auto accept = [](FrameView data) { return RESPONSE_OK; };
+  rig.appliance.queueRequest_(DEVICE_QUERY, FrameData({0x41, 0x05}), accept, [&] { parked += 'S'; },
+                              [&] { parked += 'F'; });
+  rig.run(200);
+  rig.appliance.sendUserCommand(DEVICE_QUERY, FrameData({0x41, 0x06}), accept);
+  CHECK(rig.appliance.getPreemptedRequests() == 1);
+  CHECK(rig.appliance.getQueueDepth(PRIORITY_BACKGROUND) == 1);
+  // Parked request, user command in flight and one queued: the next finds no one to displace
+  rig.appliance.queueRequestPriority_(DEVICE_QUERY, FrameData({0x41, 0x07}), accept);
+  const uint32_t dropped = rig.appliance.getDroppedRequests();
+  rig.appliance.queueRequestPriority_(DEVICE_QUERY, FrameData({0x41, 0x08}), accept);
+  CHECK(rig.appliance.getDroppedRequests() == dropped + 1);
+  CHECK(rig.appliance.getQueueDepth(PRIORITY_BACKGROUND) == 1);
+  rig.run(10000);
+  CHECK(parked == "S");
+  return test::finish();
+}
@@ -0,0 +1,43 @@
+// Response timeouts follow the unit when it slows down. After a timeout the backed-off
+// timeout is kept until a request is answered without being resent (RFC 6298 5.5, 5.7), so
+// the estimator gets samples again instead of resending every request forever.
+
+#include "test_support.h"
+
+using namespace esphome::midea;
+
+int main() {
+  RttEstimator rtt;
+  CHECK(rtt.timeout(250, 2000) == 2000);
+  rtt.sample(100);
+  CHECK(rtt.timeout(250, 2000) == 300);
+  rtt.backoff();
+  rtt.backoff();
+  CHECK(rtt.timeout(250, 2000) == 1200);
+  rtt.backoff();
+  CHECK(rtt.timeout(250, 2000) == 2000);
+  rtt.sample(100);
+  CHECK(rtt.backoffs() == 0);
+
+  test::Rig<> rig;
+  rig.appliance.setup();
+  rig.run(10 * 60000);
+  const RttEstimator &query = rig.appliance.getRtt(DEVICE_QUERY);
+  const uint32_t fast = query.srtt();
+
+  // The unit now answers in 400 ms, well past the current timeout
+  rig.emulator.config().latency = 400;
+  rig.emulator.config().jitter = 0;
+  const uint16_t samples = query.samples();
+  const EmulatorStats before = rig.emulator.stats();
+  rig.run(30 * 60000);
+  const EmulatorStats after = rig.emulator.stats();
+  const uint32_t queries = after.statusQueries + after.powerQueries - before.statusQueries - before.powerQueries;
+  printf("query srtt %u ms -> %u ms, %u new samples, %u queries received, timeout %u ms\n", fast, query.srtt(),
+         query.samples() - samples, queries, rig.appliance.getResponseTimeout(DEVICE_QUERY));
+  CHECK(fast < 250);
+  CHECK(query.srtt() >= 380);
+  CHECK(query.samples() - samples >= 10);
+  CHECK(rig.appliance.getResponseTimeout(DEVICE_QUERY) > 400);
+  return test::finish();
+}
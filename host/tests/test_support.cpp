@@ -0,0 +1,47 @@
+#include "test_support.h"
+#include <cstdlib>
+#include <new>
+
+namespace esphome {
+namespace midea {
+namespace test {
+
+static int failures = 0;
+static uint64_t counted = 0;
+static unsigned paused = 0;
+
+void fail(const char *file, int line, const char *what) {
+  printf("%s:%d: CHECK failed: %s\n", file, line, what);
+  ++failures;
+}
+
+int finish() {
+  if (failures)
+    printf("%d check(s) failed\n", failures);
+  return failures ? 1 : 0;
+}
+
+uint64_t allocations() { return counted; }
+
+AllocationPause::AllocationPause() { ++paused; }
+AllocationPause::~AllocationPause() { --paused; }
+
+}  // namespace test
+}  // namespace midea
+}  // namespace esphome
+
+/* Heap accounting for the whole test process */
+
+void *operator new(size_t size) {
+  void *ptr = malloc(size ? size : 1);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  if (!esphome::midea::test::paused)
+    ++esphome::midea::test::counted;
+  return ptr;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete[](void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
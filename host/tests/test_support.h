@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include "air_conditioner.h"
+#include "clock.h"
+#include "emulator.h"
+#include "transport.h"
+
+// Shared pieces of the host tests: failure reporting, heap accounting and an emulator line.
+//
+// A test is a plain executable run by ctest; it returns test::finish() from main(). Failed
+// checks are reported on stdout, so a test may silence the engine logs on stderr.
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) \
+      ::esphome::midea::test::fail(__FILE__, __LINE__, #cond); \
+  } while (0)
+
+namespace esphome {
+namespace midea {
+namespace test {
+
+void fail(const char *file, int line, const char *what);
+/// Exit status for main(): 0 if no CHECK failed
+int finish();
+
+/// operator new calls so far, not counting those made under an AllocationPause
+uint64_t allocations();
+
+/// Allocations made while alive are not counted, e.g. those of the emulator
+class AllocationPause {
+ public:
+  AllocationPause();
+  ~AllocationPause();
+};
+
+/// Emulator seen through the Transport interface, with its allocations left out of the count
+class EmulatorLine : public Transport {
+ public:
+  explicit EmulatorLine(ApplianceEmulator &emulator) : emulator_(emulator) {}
+  size_t available() override {
+    AllocationPause pause;
+    return this->emulator_.available();
+  }
+  size_t read(uint8_t *data, size_t size) override {
+    AllocationPause pause;
+    return this->emulator_.read(data, size);
+  }
+  void write(const uint8_t *data, size_t size) override {
+    AllocationPause pause;
+    this->emulator_.write(data, size);
+  }
+
+ protected:
+  ApplianceEmulator &emulator_;
+};
+
+/// An engine (an air conditioner, or a test subclass of it) wired to an emulated unit on a
+/// manual clock
+template<typename Appliance = ac::AirConditioner> struct Rig {
+  explicit Rig(const EmulatorConfig &config = {}) : emulator(config, &clock), line(emulator) {
+    this->appliance.setClock(&this->clock);
+    this->appliance.setTransport(&this->line);
+  }
+  /// Step the clock and loop the engine for `ms` simulated milliseconds
+  void run(uint32_t ms, uint32_t step = 10) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += step) {
+      this->clock.advance(step);
+      this->appliance.loop();
+    }
+  }
+  ManualClock clock;
+  ApplianceEmulator emulator;
+  EmulatorLine line;
+  Appliance appliance;
+};
+
+}  // namespace test
+}  // namespace midea
+}  // namespace esphome
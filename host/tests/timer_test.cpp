@@ -0,0 +1,72 @@
+// Timer registration stays bounded: timers detach from their manager when destroyed, and
+// thousands of sequenced user commands reuse the engine's own timers instead of adding one
+// per sequence.
+
+#include <algorithm>
+#include <memory>
+#include "status_data.h"
+#include "test_support.h"
+
+using namespace esphome::midea;
+
+/// Air conditioner with the sequenced command entry point exposed
+class SequencedAirConditioner : public ac::AirConditioner {
+ public:
+  using ApplianceBase::sendSequencedUserCommand;
+};
+
+int main() {
+  ManualClock clock;
+  {
+    TimerManager manager;
+    manager.setClock(&clock);
+    Timer kept;
+    manager.registerTimer(kept);
+    manager.registerTimer(kept);
+    CHECK(manager.size() == 1);
+    {
+      Timer scoped;
+      manager.startOnce(scoped, 10, [](Timer *timer) {});
+      CHECK(manager.size() == 2);
+    }
+    CHECK(manager.size() == 1);
+    // The destroyed timer was armed: it must be gone from the deadline list too
+    clock.advance(20);
+    manager.task();
+    CHECK(!manager.isDue());
+  }
+  {
+    // The manager may go first
+    Timer outlived;
+    auto manager = std::make_unique<TimerManager>();
+    manager->registerTimer(outlived);
+    outlived.start(10);
+    manager.reset();
+  }
+
+  test::Rig<SequencedAirConditioner> rig;
+  rig.appliance.setup();
+  rig.run(30000);
+  const size_t timers = rig.appliance.getTimerCount();
+  const uint32_t sent = rig.appliance.getPacer().getSent();
+  size_t most = timers;
+  for (unsigned sequence = 0; sequence < 5000; ++sequence) {
+    for (unsigned step = 0; step < 3; ++step) {
+      ac::StatusData status;
+      status.setTargetTemp(18.0F + (sequence + step) % 12);
+      status.seal();
+      rig.appliance.sendSequencedUserCommand(DEVICE_CONTROL, status);
+    }
+    for (unsigned i = 0; i < 300; ++i) {
+      rig.run(10);
+      most = std::max(most, rig.appliance.getTimerCount());
+    }
+  }
+  printf("5000 sequences: %u frames sent, %zu timers after setup, at most %zu\n",
+         rig.appliance.getPacer().getSent() - sent, timers, most);
+  CHECK(rig.appliance.getPacer().getSent() - sent >= 15000);
+  // Only the sequence delay timer joins the setup timers, once, and is then reused
+  CHECK(most <= timers + 1);
+  CHECK(rig.appliance.getTimerCount() <= timers + 1);
+  return test::finish();
+}